@@ -0,0 +1,380 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder.h"
+
+// every allocation of the program is counted, so that the benchmarks can report
+// how many allocations an operation makes next to its time
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+void* counted_alloc(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n != 0 ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+// aligned_alloc wants the size to be a multiple of the alignment
+void* counted_alloc(std::size_t n, std::align_val_t al) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto const a = static_cast<std::size_t>(al);
+    if (void* p = std::aligned_alloc(a, ((n != 0 ? n : 1) + a - 1) / a * a))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void* counted_alloc_nothrow(std::size_t n) noexcept {
+    try {
+        return counted_alloc(n);
+    } catch (std::bad_alloc const&) {
+        return nullptr;
+    }
+}
+
+void* counted_alloc_nothrow(std::size_t n, std::align_val_t al) noexcept {
+    try {
+        return counted_alloc(n, al);
+    } catch (std::bad_alloc const&) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    return counted_alloc(n);
+}
+
+void* operator new[](std::size_t n) {
+    return counted_alloc(n);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t n, std::nothrow_t const&) noexcept {
+    return counted_alloc_nothrow(n);
+}
+
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept {
+    return counted_alloc_nothrow(n);
+}
+
+void operator delete(void* p, std::nothrow_t const&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::nothrow_t const&) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    return counted_alloc(n, al);
+}
+
+void* operator new[](std::size_t n, std::align_val_t al) {
+    return counted_alloc(n, al);
+}
+
+void* operator new(std::size_t n, std::align_val_t al, std::nothrow_t const&) noexcept {
+    return counted_alloc_nothrow(n, al);
+}
+
+void* operator new[](std::size_t n, std::align_val_t al, std::nothrow_t const&) noexcept {
+    return counted_alloc_nothrow(n, al);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct hash_slab_traits : cxx::default_binder_traits {
+    using index = cxx::hash_index;
+    using storage = cxx::slab_storage;
+};
+
+struct persistent_traits : cxx::default_binder_traits {
+    using storage = cxx::persistent_storage;
+};
+
+// allocations made while the timer runs, reported per iteration
+class alloc_counter {
+    benchmark::State& state;
+    std::uint64_t start;
+    std::uint64_t excluded;
+
+public:
+
+    explicit alloc_counter(benchmark::State& s)
+        : state{s}, start{allocations.load(std::memory_order_relaxed)}, excluded{} {}
+
+    // runs setup with the timer stopped and without counting its allocations
+    template <typename F>
+    void exclude(F&& setup) {
+        state.PauseTiming();
+        auto before = allocations.load(std::memory_order_relaxed);
+        setup();
+        excluded += allocations.load(std::memory_order_relaxed) - before;
+        state.ResumeTiming();
+    }
+
+    ~alloc_counter() {
+        auto total = allocations.load(std::memory_order_relaxed) - start - excluded;
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(total),
+            benchmark::Counter::kAvgIterations);
+    }
+}; // class alloc_counter
+
+template <typename K>
+K make_key(std::size_t i);
+
+template <>
+int make_key<int>(std::size_t i) {
+    return static_cast<int>(i);
+}
+
+// longer than the small string buffer, so that keys live on the heap like real ones
+template <>
+std::string make_key<std::string>(std::size_t i) {
+    return "binder-benchmark-key-" + std::to_string(i);
+}
+
+template <typename K>
+std::vector<K> make_keys(std::size_t n) {
+    std::vector<K> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        keys.push_back(make_key<K>(i));
+    return keys;
+}
+
+template <typename K, typename Traits>
+using binder_t = cxx::binder<K, int, Traits>;
+
+template <typename K, typename Traits>
+binder_t<K, Traits> make_binder(std::vector<K> const& keys) {
+    binder_t<K, Traits> b;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        b.insert_front(keys[i], static_cast<int>(i));
+    return b;
+}
+
+std::size_t size_of(benchmark::State const& state) {
+    return static_cast<std::size_t>(state.range(0));
+}
+
+template <typename K, typename Traits>
+void insert_front(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        binder_t<K, Traits> b;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            b.insert_front(keys[i], static_cast<int>(i));
+        benchmark::DoNotOptimize(b);
+        allocs.exclude([&b] { b = binder_t<K, Traits>{}; });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void insert_after(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        binder_t<K, Traits> b;
+        b.insert_front(keys[0], 0);
+        for (std::size_t i = 1; i < keys.size(); ++i)
+            b.insert_after(keys[i - 1], keys[i], static_cast<int>(i));
+        benchmark::DoNotOptimize(b);
+        allocs.exclude([&b] { b = binder_t<K, Traits>{}; });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void read_const(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto const b = make_binder<K, Traits>(keys);
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        for (auto const& k : keys)
+            benchmark::DoNotOptimize(b.read(k));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+// on an unshared binder, so no clone is involved
+template <typename K, typename Traits>
+void read_mutable(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto b = make_binder<K, Traits>(keys);
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        for (auto const& k : keys)
+            benchmark::DoNotOptimize(++b.read(k));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void remove_front(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    binder_t<K, Traits> b;
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        allocs.exclude([&] { b = make_binder<K, Traits>(keys); });
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            b.remove();
+        benchmark::DoNotOptimize(b);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void remove_key(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    binder_t<K, Traits> b;
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        allocs.exclude([&] { b = make_binder<K, Traits>(keys); });
+        for (auto const& k : keys)
+            b.remove(k);
+        benchmark::DoNotOptimize(b);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void iterate(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto const b = make_binder<K, Traits>(keys);
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        long sum = 0;
+        for (auto it = b.cbegin(); it != b.cend(); ++it)
+            sum += *it;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+// the copy is cheap, the first modification of either binder clones the notes
+template <typename K, typename Traits>
+void copy_then_mutate(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto const b = make_binder<K, Traits>(keys);
+    auto const extra = make_key<K>(keys.size());
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        auto c = b;
+        c.insert_front(extra, 0);
+        benchmark::DoNotOptimize(c);
+        allocs.exclude([&c] { c = binder_t<K, Traits>{}; });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+// a binder that handed out a reference by non-const read() can't be shared,
+// so the copy itself clones the notes
+template <typename K, typename Traits>
+void copy_after_read(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto b = make_binder<K, Traits>(keys);
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(b.read(keys[0]));
+        auto c = b;
+        benchmark::DoNotOptimize(c);
+        allocs.exclude([&c] { c = binder_t<K, Traits>{}; });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template <typename K, typename Traits>
+void move_assign(benchmark::State& state) {
+    auto keys = make_keys<K>(size_of(state));
+    auto b = make_binder<K, Traits>(keys);
+    binder_t<K, Traits> c;
+    alloc_counter allocs{state};
+    for (auto _ : state) {
+        c = std::move(b);
+        b = std::move(c);
+        benchmark::DoNotOptimize(b);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+void sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(1, 1'000'000);
+}
+
+} // namespace
+
+// every scenario for every combination of key type and policy
+#define BINDER_BENCHMARK(fn)                                                    \
+    BENCHMARK_TEMPLATE(fn, int, cxx::default_binder_traits)->Apply(sizes);      \
+    BENCHMARK_TEMPLATE(fn, int, hash_slab_traits)->Apply(sizes);                \
+    BENCHMARK_TEMPLATE(fn, int, persistent_traits)->Apply(sizes);               \
+    BENCHMARK_TEMPLATE(fn, std::string, cxx::default_binder_traits)->Apply(sizes); \
+    BENCHMARK_TEMPLATE(fn, std::string, hash_slab_traits)->Apply(sizes);        \
+    BENCHMARK_TEMPLATE(fn, std::string, persistent_traits)->Apply(sizes)
+
+BINDER_BENCHMARK(insert_front);
+BINDER_BENCHMARK(insert_after);
+BINDER_BENCHMARK(read_const);
+BINDER_BENCHMARK(read_mutable);
+BINDER_BENCHMARK(remove_front);
+BINDER_BENCHMARK(remove_key);
+BINDER_BENCHMARK(iterate);
+BINDER_BENCHMARK(copy_then_mutate);
+BINDER_BENCHMARK(copy_after_read);
+BINDER_BENCHMARK(move_assign);
+
+BENCHMARK_MAIN();
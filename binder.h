@@ -5,225 +5,4750 @@
 #include <utility>
 #include <list>
 #include <map>
+#include <vector>
 #include <memory>
 #include <stdexcept>
 #include <optional>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <bit>
+#include <iterator>
+#include <atomic>
+#include <type_traits>
+#include <concepts>
+#include <string_view>
+#include <memory_resource>
+#include <ranges>
+#include <initializer_list>
+#include <tuple>
+#include <array>
+#include <variant>
+#include <thread>
+#include <exception>
+#include <chrono>
+#include <mutex>
+#include <future>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace cxx {
 
+namespace detail {
+
+template <typename Alloc, typename T>
+using rebind_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+// Q and K can be compared by operator< both ways
+template <typename K, typename Q>
+concept ordered_with = requires(K const& k, Q const& q) {
+    { k < q } -> std::convertible_to<bool>;
+    { q < k } -> std::convertible_to<bool>;
+};
+
+// orders pointers to keys by the keys they point to, and against any key type
+// comparable with them
+template <typename K>
+struct deref_less {
+    using is_transparent = void;
+
+    bool operator()(K const* a, K const* b) const {
+        return *a < *b;
+    }
+
+    template <typename Q>
+    bool operator()(K const* a, Q const& b) const {
+        return *a < b;
+    }
+
+    template <typename Q>
+    bool operator()(Q const& a, K const* b) const {
+        return a < *b;
+    }
+};
+
+// key indices do not own keys, they point at the key stored in each note
+// and must be given a rekeying function to be copied
+
+// ordered key index backed by std::map, lookups are O(log n)
+template <typename K, typename Mapped, typename Alloc = std::allocator<std::byte>>
+class ordered_map_index {
+
+    using map_type = std::map<K const*, Mapped, deref_less<K>, rebind_alloc_t<Alloc, std::pair<K const* const, Mapped>>>;
+
+    map_type map;
+
+public:
+
+    // result of locate(), valid until the index is modified
+    struct position {
+        typename map_type::iterator iter;
+        bool found;
+    };
+
+    // key types that lookups accept besides K
+    template <typename Q>
+    static constexpr bool accepts = ordered_with<K, Q>;
+
+    explicit ordered_map_index(Alloc const& a = Alloc()) : map{a} {}
+
+    // copies rhs with every key taken from rekey(mapped), which must preserve the order;
+    // entries are appended in order, so no key comparisons are needed. rekey may return
+    // the pair of the new key and mapped instead, for copies whose handles differ
+    template <typename Rekey>
+    ordered_map_index(ordered_map_index const& rhs, Alloc const& a, Rekey rekey) : map{a} {
+        for (auto const& [k, m] : rhs.map) {
+            if constexpr (std::is_pointer_v<std::invoke_result_t<Rekey&, Mapped const&>>) {
+                map.emplace_hint(map.end(), rekey(m), m);
+            }
+            else {
+                auto [key, mapped] = rekey(m);
+                map.emplace_hint(map.end(), key, mapped);
+            }
+        }
+    }
+
+    ordered_map_index(ordered_map_index const&) = delete;
+    ordered_map_index(ordered_map_index&&) = default;
+
+    template <typename Q>
+    Mapped* find(Q const& k) {
+        auto iter = map.find(k);
+        return (iter == map.end()) ? nullptr : &iter->second;
+    }
+
+    template <typename Q>
+    Mapped const* find(Q const& k) const {
+        auto iter = map.find(k);
+        return (iter == map.end()) ? nullptr : &iter->second;
+    }
+
+    template <typename Q>
+    bool contains(Q const& k) const {
+        return map.contains(k);
+    }
+
+    // single lookup that serves both a following insert_at() and erase_at()
+    template <typename Q>
+    position locate(Q const& k) {
+        auto iter = map.lower_bound(k);
+        return {iter, iter != map.end() && !(k < *iter->first)};
+    }
+
+    Mapped& mapped_at(position const& p) const noexcept {
+        return p.iter->second;
+    }
+
+    // p must be the result of locate(*k) and not found
+    void insert_at(position const& p, K const* k, Mapped const& m) {
+        map.emplace_hint(p.iter, k, m);
+    }
+
+    // p must be found
+    void erase_at(position const& p) noexcept {
+        map.erase(p.iter);
+    }
+
+    // moves the found entry at p into dst as (k, m), where *k equals its key; the map node
+    // itself is moved, so nothing is allocated, which requires equal allocators
+    void move_entry_at(position const& p, K const* k, Mapped const& m, ordered_map_index& dst) {
+        auto entry = map.extract(p.iter);
+        entry.key() = k;
+        entry.mapped() = m;
+        dst.map.insert(std::move(entry));
+    }
+
+    Alloc get_allocator() const noexcept {
+        return Alloc(map.get_allocator());
+    }
+
+    // returns false and leaves the index unchanged if *k is already present
+    bool insert(K const* k, Mapped const& m) {
+        return map.emplace(k, m).second;
+    }
+
+    template <typename Q>
+    void erase(Q const& k) {
+        auto iter = map.find(k);
+        if (iter != map.end())
+            map.erase(iter);
+    }
+
+    // std::map allocates per node, there is nothing to reserve
+    void reserve(std::size_t) noexcept {}
+
+    // entries with keys in [lo, hi) in key order
+    template <typename Q>
+    auto range(Q const& lo, Q const& hi) const {
+        auto first = map.lower_bound(lo);
+        auto last = (lo < hi) ? map.lower_bound(hi) : first;
+        return std::ranges::subrange(first, last);
+    }
+
+    // fills an empty index with entries of distinct keys, sorting them first so that
+    // every node is inserted at the end of the map in amortized constant time
+    template <typename Entries>
+    void bulk_insert(Entries& entries) {
+        std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+            return *a.first < *b.first;
+        });
+        for (auto const& [k, m] : entries)
+            map.emplace_hint(map.end(), k, m);
+    }
+
+    // same as bulk_insert, but returns false without inserting anything if two entries
+    // have equal keys
+    template <typename Entries>
+    bool bulk_insert_unique(Entries& entries) {
+        std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+            return *a.first < *b.first;
+        });
+        auto repeated = std::adjacent_find(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+            return !(*a.first < *b.first);
+        });
+        if (repeated != entries.end())
+            return false;
+        for (auto const& [k, m] : entries)
+            map.emplace_hint(map.end(), k, m);
+        return true;
+    }
+
+    // bytes allocated outside the object, estimated for a red-black tree node of
+    // three pointers and a color per entry
+    std::size_t memory_usage() const noexcept {
+        return map.size() * (sizeof(typename map_type::value_type) + 4 * sizeof(void*));
+    }
+
+    std::size_t size() const noexcept {
+        return map.size();
+    }
+
+    bool empty() const noexcept {
+        return map.empty();
+    }
+}; // class ordered_map_index
+
+// open-addressing key index with linear probing, lookups are O(1) on average;
+// control bytes are kept apart from the slots so that probing scans a flat byte array
+template <typename K, typename Mapped, typename Alloc = std::allocator<std::byte>,
+    typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+class flat_hash_index {
+
+    struct slot {
+        K const* key;
+        Mapped mapped;
+    };
+
+    // control byte values, a full slot stores the top bits of its hash with the high bit set
+    static constexpr std::uint8_t empty_slot = 0;
+    static constexpr std::uint8_t deleted_slot = 1;
+
+    static constexpr std::size_t min_capacity = 16;
+
+    using slot_alloc_t = rebind_alloc_t<Alloc, slot>;
+    using ctrl_alloc_t = rebind_alloc_t<Alloc, std::uint8_t>;
+
+    [[no_unique_address]] slot_alloc_t alloc;
+    std::uint8_t* ctrl;
+    slot* slots;
+    std::size_t capacity;
+    // number of full slots
+    std::size_t count;
+    // number of tombstones left behind by erase
+    std::size_t deleted;
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] Equal equal;
+
+    static std::uint64_t mix(std::size_t h) noexcept {
+        std::uint64_t x = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+        return x ^ (x >> 29);
+    }
+
+    static std::uint8_t fragment(std::uint64_t h) noexcept {
+        return static_cast<std::uint8_t>(0x80 | (h >> 57));
+    }
+
+    static bool is_full(std::uint8_t c) noexcept {
+        return c & 0x80;
+    }
+
+    // allocates n zeroed control bytes and n uninitialized slots
+    std::pair<std::uint8_t*, slot*> allocate_table(std::size_t n) {
+        ctrl_alloc_t ctrl_alloc{alloc};
+        std::uint8_t* c = ctrl_alloc.allocate(n);
+        try {
+            slot* p = alloc.allocate(n);
+            std::fill_n(c, n, empty_slot);
+            return {c, p};
+        }
+        catch (...) {
+            ctrl_alloc.deallocate(c, n);
+            throw;
+        }
+    }
+
+    void deallocate_table(std::uint8_t* c, slot* p, std::size_t n) noexcept {
+        ctrl_alloc_t{alloc}.deallocate(c, n);
+        alloc.deallocate(p, n);
+    }
+
+    void destroy() noexcept {
+        if (slots == nullptr)
+            return;
+        for (std::size_t i = 0; i < capacity; ++i)
+            if (is_full(ctrl[i]))
+                std::destroy_at(&slots[i]);
+        deallocate_table(ctrl, slots, capacity);
+        slots = nullptr;
+        ctrl = nullptr;
+        capacity = count = deleted = 0;
+    }
+
+    // returns the position of k or capacity if it is absent
+    template <typename Q>
+    std::size_t find_pos(Q const& k) const {
+        if (count == 0)
+            return capacity;
+        auto h = mix(hasher(k));
+        auto frag = fragment(h);
+        std::size_t mask = capacity - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            if (ctrl[i] == empty_slot)
+                return capacity;
+            if (ctrl[i] == frag && equal(*slots[i].key, k))
+                return i;
+        }
+    }
+
+    // moves every full slot into a fresh table of new_capacity slots, dropping tombstones
+    void rehash(std::size_t new_capacity) {
+        auto [new_ctrl, new_slots] = allocate_table(new_capacity);
+        std::size_t mask = new_capacity - 1;
+        std::size_t moved = 0;
+        try {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                if (!is_full(ctrl[i]))
+                    continue;
+                auto h = mix(hasher(*slots[i].key));
+                std::size_t j = h & mask;
+                while (new_ctrl[j] != empty_slot)
+                    j = (j + 1) & mask;
+                std::construct_at(&new_slots[j], std::move_if_noexcept(slots[i]));
+                new_ctrl[j] = fragment(h);
+                ++moved;
+            }
+        }
+        catch (...) {
+            for (std::size_t j = 0; j < new_capacity; ++j)
+                if (is_full(new_ctrl[j]))
+                    std::destroy_at(&new_slots[j]);
+            deallocate_table(new_ctrl, new_slots, new_capacity);
+            throw;
+        }
+        std::size_t old_count = count;
+        destroy();
+        ctrl = new_ctrl;
+        slots = new_slots;
+        capacity = new_capacity;
+        count = old_count;
+    }
+
+    // keeps the load factor including tombstones at most 7/8
+    void grow_for(std::size_t n) {
+        if (capacity != 0 && (n + deleted) * 8 <= capacity * 7)
+            return;
+        std::size_t new_capacity = std::max(capacity, min_capacity);
+        while (n * 8 > new_capacity * 7)
+            new_capacity *= 2;
+        rehash(new_capacity);
+    }
+
+    // *k must be absent and the table must have room for it
+    void insert_new(K const* k, Mapped const& m) {
+        insert_new(k, m, mix(hasher(*k)));
+    }
+
+    void insert_new(K const* k, Mapped const& m, std::uint64_t h) {
+        std::size_t mask = capacity - 1;
+        std::size_t i = h & mask;
+        while (is_full(ctrl[i]))
+            i = (i + 1) & mask;
+        std::construct_at(&slots[i], slot{k, m});
+        if (ctrl[i] == deleted_slot)
+            --deleted;
+        ctrl[i] = fragment(h);
+        ++count;
+    }
+
+public:
+
+    // key types that lookups accept besides K, only with a transparent Hash and Equal
+    template <typename Q>
+    static constexpr bool accepts = requires(Hash const& h, Equal const& e, K const& k, Q const& q) {
+        typename Hash::is_transparent;
+        typename Equal::is_transparent;
+        { h(q) } -> std::convertible_to<std::size_t>;
+        { e(k, q) } -> std::convertible_to<bool>;
+    };
+
+    explicit flat_hash_index(Alloc const& a = Alloc()) noexcept
+        : alloc{a}, ctrl{}, slots{}, capacity{}, count{}, deleted{}, hasher{}, equal{} {}
+
+    // copies the table of rhs slot by slot with every key taken from rekey(mapped),
+    // which must point at an equal key, so nothing is rehashed
+    template <typename Rekey>
+    flat_hash_index(flat_hash_index const& rhs, Alloc const& a, Rekey rekey)
+        : alloc{a}, ctrl{}, slots{}, capacity{}, count{}, deleted{}, hasher{rhs.hasher}, equal{rhs.equal} {
+        if (rhs.count == 0)
+            return;
+        std::tie(ctrl, slots) = allocate_table(rhs.capacity);
+        capacity = rhs.capacity;
+        try {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                if (is_full(rhs.ctrl[i])) {
+                    std::construct_at(&slots[i], slot{rekey(rhs.slots[i].mapped), rhs.slots[i].mapped});
+                    ++count;
+                }
+                // tombstones are kept too, probe sequences of the copied keys run through them
+                else if (rhs.ctrl[i] == deleted_slot)
+                    ++deleted;
+                ctrl[i] = rhs.ctrl[i];
+            }
+        }
+        catch (...) {
+            destroy();
+            throw;
+        }
+    }
+
+    flat_hash_index(flat_hash_index const&) = delete;
+
+    flat_hash_index(flat_hash_index&& rhs) noexcept
+        : alloc{rhs.alloc}, ctrl{std::exchange(rhs.ctrl, nullptr)}, slots{std::exchange(rhs.slots, nullptr)},
+          capacity{std::exchange(rhs.capacity, 0)}, count{std::exchange(rhs.count, 0)},
+          deleted{std::exchange(rhs.deleted, 0)}, hasher{std::move(rhs.hasher)}, equal{std::move(rhs.equal)} {}
+
+    flat_hash_index& operator=(flat_hash_index const&) = delete;
+    flat_hash_index& operator=(flat_hash_index&&) = delete;
+
+    ~flat_hash_index() noexcept {
+        destroy();
+    }
+
+    template <typename Q>
+    Mapped* find(Q const& k) {
+        auto pos = find_pos(k);
+        return (pos == capacity) ? nullptr : &slots[pos].mapped;
+    }
+
+    template <typename Q>
+    Mapped const* find(Q const& k) const {
+        auto pos = find_pos(k);
+        return (pos == capacity) ? nullptr : &slots[pos].mapped;
+    }
+
+    template <typename Q>
+    bool contains(Q const& k) const {
+        return find_pos(k) != capacity;
+    }
+
+    // result of locate(), valid until the index is modified; pos is the slot
+    // of the key if found, otherwise the first free slot on its probe sequence
+    struct position {
+        std::size_t pos;
+        std::uint64_t hash;
+        bool found;
+    };
+
+    // single lookup that serves both a following insert_at() and erase_at()
+    template <typename Q>
+    position locate(Q const& k) const {
+        auto h = mix(hasher(k));
+        if (capacity == 0)
+            return {capacity, h, false};
+        auto frag = fragment(h);
+        std::size_t mask = capacity - 1;
+        std::size_t free = capacity;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            if (ctrl[i] == empty_slot)
+                return {(free == capacity) ? i : free, h, false};
+            if (ctrl[i] == deleted_slot && free == capacity)
+                free = i;
+            else if (ctrl[i] == frag && equal(*slots[i].key, k))
+                return {i, h, true};
+        }
+    }
+
+    Mapped& mapped_at(position const& p) const noexcept {
+        return slots[p.pos].mapped;
+    }
+
+    // p must be the result of locate(*k) and not found
+    void insert_at(position const& p, K const* k, Mapped const& m) {
+        if (capacity == 0 || (ctrl[p.pos] == empty_slot && (count + deleted + 1) * 8 > capacity * 7)) {
+            grow_for(count + 1);
+            insert_new(k, m, p.hash);
+            return;
+        }
+        std::construct_at(&slots[p.pos], slot{k, m});
+        if (ctrl[p.pos] == deleted_slot)
+            --deleted;
+        ctrl[p.pos] = fragment(p.hash);
+        ++count;
+    }
+
+    // p must be found
+    void erase_at(position const& p) noexcept {
+        std::size_t pos = p.pos;
+        std::destroy_at(&slots[pos]);
+        // a slot followed by an empty one ends every probe sequence through it
+        ctrl[pos] = (ctrl[(pos + 1) & (capacity - 1)] == empty_slot) ? empty_slot : deleted_slot;
+        if (ctrl[pos] == deleted_slot)
+            ++deleted;
+        --count;
+    }
+
+    // moves the found entry at p into dst as (k, m), where *k equals its key;
+    // allocates nothing if dst has been reserved for it
+    void move_entry_at(position const& p, K const* k, Mapped const& m, flat_hash_index& dst) {
+        erase_at(p);
+        dst.insert(k, m);
+    }
+
+    Alloc get_allocator() const noexcept {
+        return Alloc(alloc);
+    }
+
+    // returns false and leaves the index unchanged if *k is already present
+    bool insert(K const* k, Mapped const& m) {
+        if (contains(*k))
+            return false;
+        grow_for(count + 1);
+        insert_new(k, m);
+        return true;
+    }
+
+    template <typename Q>
+    void erase(Q const& k) {
+        auto pos = find_pos(k);
+        if (pos != capacity)
+            erase_at({pos, 0, true});
+    }
+
+    void reserve(std::size_t n) {
+        grow_for(n);
+    }
+
+    // fills an empty index with entries of distinct keys, sized once up front
+    template <typename Entries>
+    void bulk_insert(Entries& entries) {
+        grow_for(entries.size());
+        for (auto const& [k, m] : entries)
+            insert_new(k, m);
+    }
+
+    // same as bulk_insert, but returns false if two entries have equal keys,
+    // after which the index is only fit to be destroyed
+    template <typename Entries>
+    bool bulk_insert_unique(Entries& entries) {
+        grow_for(entries.size());
+        for (auto const& [k, m] : entries) {
+            auto pos = locate(*k);
+            if (pos.found)
+                return false;
+            insert_at(pos, k, m);
+        }
+        return true;
+    }
+
+    // bytes allocated outside the object
+    std::size_t memory_usage() const noexcept {
+        return capacity * (sizeof(slot) + sizeof(std::uint8_t));
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+}; // class flat_hash_index
+
+// keys searched by comparing their object representations, which for these types
+// is the same as comparing them with operator==
+template <typename K>
+concept packed_key = (std::is_integral_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>)
+    && (sizeof(K) == 1 || sizeof(K) == 2 || sizeof(K) == 4 || sizeof(K) == 8);
+
+// position of k among keys[0, n), n if absent
+template <packed_key K>
+std::size_t find_packed(K const* keys, std::size_t n, K k) noexcept {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    constexpr std::size_t lanes = 16 / sizeof(K);
+    __m128i needle;
+    if constexpr (sizeof(K) == 1)
+        needle = _mm_set1_epi8(std::bit_cast<char>(k));
+    else if constexpr (sizeof(K) == 2)
+        needle = _mm_set1_epi16(std::bit_cast<short>(k));
+    else if constexpr (sizeof(K) == 4)
+        needle = _mm_set1_epi32(std::bit_cast<int>(k));
+    else
+        needle = _mm_set1_epi64x(std::bit_cast<long long>(k));
+    for (; i + lanes <= n; i += lanes) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(keys + i));
+        __m128i eq;
+        if constexpr (sizeof(K) == 1)
+            eq = _mm_cmpeq_epi8(block, needle);
+        else if constexpr (sizeof(K) == 2)
+            eq = _mm_cmpeq_epi16(block, needle);
+        else if constexpr (sizeof(K) == 4)
+            eq = _mm_cmpeq_epi32(block, needle);
+        else {
+            // a 64-bit lane is equal if both of its 32-bit halves are
+            eq = _mm_cmpeq_epi32(block, needle);
+            eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        if (mask != 0)
+            return i + static_cast<std::size_t>(std::countr_zero(mask)) / sizeof(K);
+    }
+#endif
+    for (; i < n; ++i)
+        if (keys[i] == k)
+            return i;
+    return n;
+}
+
+// key index for binders of at most Threshold notes: keys are copied into a packed
+// array kept inside the index and searched linearly, with SIMD where available;
+// on growing past Threshold it moves its entries into Large for good
+template <packed_key K, typename Mapped, typename Alloc, std::size_t Threshold, typename Large>
+class small_key_index {
+
+    struct slot {
+        K const* key;
+        Mapped mapped;
+    };
+
+    struct packed {
+        // keys[i] is a copy of *slots[i].key
+        std::array<K, Threshold> keys;
+        std::array<slot, Threshold> slots;
+        std::size_t count;
+
+        // leaves the arrays uninitialized
+        packed() noexcept : count{} {}
+    };
+
+    std::variant<packed, Large> state;
+    [[no_unique_address]] Alloc alloc;
+
+    packed& small() noexcept {
+        return *std::get_if<packed>(&state);
+    }
+
+    packed const& small() const noexcept {
+        return *std::get_if<packed>(&state);
+    }
+
+    Large* large() noexcept {
+        return std::get_if<Large>(&state);
+    }
+
+    Large const* large() const noexcept {
+        return std::get_if<Large>(&state);
+    }
+
+    std::size_t find_pos(K const& k) const noexcept {
+        auto const& s = small();
+        return find_packed(s.keys.data(), s.count, k);
+    }
+
+    void append(K const* k, Mapped const& m) noexcept {
+        auto& s = small();
+        s.keys[s.count] = *k;
+        s.slots[s.count] = {k, m};
+        ++s.count;
+    }
+
+    // moves every entry into a new large index sized for n
+    void spill(std::size_t n) {
+        auto const& s = small();
+        std::vector<std::pair<K const*, Mapped>, rebind_alloc_t<Alloc, std::pair<K const*, Mapped>>> entries(alloc);
+        entries.reserve(s.count);
+        for (std::size_t i = 0; i < s.count; ++i)
+            entries.emplace_back(s.slots[i].key, s.slots[i].mapped);
+        Large res(alloc);
+        res.reserve(n);
+        res.bulk_insert(entries);
+        state.template emplace<Large>(std::move(res));
+    }
+
+public:
+
+    // result of locate(), valid until the index is modified
+    struct position {
+        std::size_t pos;
+        bool found;
+        typename Large::position large_pos;
+    };
+
+    // packed keys are cheap to construct, lookups take K only
+    template <typename Q>
+    static constexpr bool accepts = false;
+
+    explicit small_key_index(Alloc const& a = Alloc()) : state{}, alloc{a} {}
+
+    template <typename Rekey>
+    small_key_index(small_key_index const& rhs, Alloc const& a, Rekey rekey) : state{}, alloc{a} {
+        if (auto l = rhs.large()) {
+            state.template emplace<Large>(*l, a, rekey);
+            return;
+        }
+        auto const& r = rhs.small();
+        auto& s = small();
+        for (std::size_t i = 0; i < r.count; ++i) {
+            s.keys[i] = r.keys[i];
+            s.slots[i] = {rekey(r.slots[i].mapped), r.slots[i].mapped};
+        }
+        s.count = r.count;
+    }
+
+    small_key_index(small_key_index const&) = delete;
+    small_key_index(small_key_index&&) = default;
+
+    Mapped* find(K const& k) {
+        if (auto l = large())
+            return l->find(k);
+        auto pos = find_pos(k);
+        return (pos == small().count) ? nullptr : &small().slots[pos].mapped;
+    }
+
+    Mapped const* find(K const& k) const {
+        if (auto l = large())
+            return l->find(k);
+        auto pos = find_pos(k);
+        return (pos == small().count) ? nullptr : &small().slots[pos].mapped;
+    }
+
+    bool contains(K const& k) const {
+        if (auto l = large())
+            return l->contains(k);
+        return find_pos(k) != small().count;
+    }
+
+    // single lookup that serves both a following insert_at() and erase_at()
+    position locate(K const& k) {
+        if (auto l = large()) {
+            auto p = l->locate(k);
+            return {0, p.found, p};
+        }
+        auto pos = find_pos(k);
+        return {pos, pos != small().count, {}};
+    }
+
+    Mapped& mapped_at(position const& p) noexcept {
+        if (auto l = large())
+            return l->mapped_at(p.large_pos);
+        return small().slots[p.pos].mapped;
+    }
+
+    // p must be the result of locate(*k) and not found
+    void insert_at(position const& p, K const* k, Mapped const& m) {
+        if (auto l = large()) {
+            l->insert_at(p.large_pos, k, m);
+            return;
+        }
+        if (small().count < Threshold) {
+            append(k, m);
+            return;
+        }
+        spill(Threshold + 1);
+        large()->insert(k, m);
+    }
+
+    // p must be found; the last entry takes the place of the erased one
+    void erase_at(position const& p) noexcept {
+        if (auto l = large()) {
+            l->erase_at(p.large_pos);
+            return;
+        }
+        auto& s = small();
+        --s.count;
+        s.keys[p.pos] = s.keys[s.count];
+        s.slots[p.pos] = s.slots[s.count];
+    }
+
+    // moves the found entry at p into dst as (k, m), where *k equals its key;
+    // allocates nothing if dst has been reserved for it
+    void move_entry_at(position const& p, K const* k, Mapped const& m, small_key_index& dst) {
+        erase_at(p);
+        dst.insert(k, m);
+    }
+
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
+    // returns false and leaves the index unchanged if *k is already present
+    bool insert(K const* k, Mapped const& m) {
+        auto p = locate(*k);
+        if (p.found)
+            return false;
+        insert_at(p, k, m);
+        return true;
+    }
+
+    void erase(K const& k) {
+        auto p = locate(k);
+        if (p.found)
+            erase_at(p);
+    }
+
+    void reserve(std::size_t n) {
+        if (auto l = large())
+            l->reserve(n);
+        else if (n > Threshold)
+            spill(n);
+    }
+
+    // fills an empty index with entries of distinct keys
+    template <typename Entries>
+    void bulk_insert(Entries& entries) {
+        if (entries.size() > Threshold) {
+            state.template emplace<Large>(alloc);
+            large()->bulk_insert(entries);
+            return;
+        }
+        for (auto const& [k, m] : entries)
+            append(k, m);
+    }
+
+    // same as bulk_insert, but returns false if two entries have equal keys,
+    // after which the index is only fit to be destroyed
+    template <typename Entries>
+    bool bulk_insert_unique(Entries& entries) {
+        if (entries.size() > Threshold) {
+            state.template emplace<Large>(alloc);
+            return large()->bulk_insert_unique(entries);
+        }
+        for (auto const& [k, m] : entries) {
+            if (find_pos(*k) != small().count)
+                return false;
+            append(k, m);
+        }
+        return true;
+    }
+
+    // bytes allocated outside the object, the packed array is a part of it
+    std::size_t memory_usage() const noexcept {
+        if (auto l = large())
+            return l->memory_usage();
+        return 0;
+    }
+
+    std::size_t size() const noexcept {
+        if (auto l = large())
+            return l->size();
+        return small().count;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+}; // class small_key_index
+
+template <typename K, typename Mapped, typename Alloc, std::size_t Threshold, typename Large>
+struct select_small_index {
+    using type = Large;
+};
+
+template <packed_key K, typename Mapped, typename Alloc, std::size_t Threshold, typename Large>
+struct select_small_index<K, Mapped, Alloc, Threshold, Large> {
+    using type = small_key_index<K, Mapped, Alloc, Threshold, Large>;
+};
+
+// key index that builds Inner only once a lookup needs it: until then entries are
+// appended to an array, and whether a new key is already present is answered by a
+// Bloom filter, verified by a scan of the array on a hit; a hit of any other lookup,
+// or scans adding up to scan_budget times the number of entries, build Inner
+template <typename K, typename Mapped, typename Alloc, typename Inner, typename Hash>
+class lazy_key_index {
+
+    using entry = std::pair<K const*, Mapped>;
+    template <typename T>
+    using vector_type = std::vector<T, rebind_alloc_t<Alloc, T>>;
+
+    static constexpr std::size_t filter_bits_per_key = 24;
+    static constexpr std::size_t filter_probes = 12;
+    static constexpr std::size_t scan_budget = 16;
+
+    // engaged once built is set; const lookups of a shared binder may build it
+    // concurrently, so the build is serialized by build_lock and published by built
+    mutable std::optional<Inner> index;
+    mutable std::atomic<bool> built;
+    mutable std::mutex build_lock;
+
+    // entries in insertion order with the upper halves of the hashes of their keys,
+    // only read once the index is built and released by the next modification
+    vector_type<entry> pending;
+    vector_type<std::uint32_t> fingerprints;
+    vector_type<std::uint64_t> filter;
+    // entries compared by scans so far
+    std::size_t scanned;
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] Alloc alloc;
+
+    static bool equivalent(K const& a, K const& b) {
+        if constexpr (std::equality_comparable<K>)
+            return a == b;
+        else
+            return !(a < b) && !(b < a);
+    }
+
+    // splitmix64 finalizer, std::hash of integers is often the identity
+    std::uint64_t hash_of(K const& k) const {
+        std::uint64_t z = static_cast<std::uint64_t>(hasher(k));
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static std::uint32_t fingerprint(std::uint64_t h) noexcept {
+        return static_cast<std::uint32_t>(h >> 32);
+    }
+
+    // i-th filter bit of a key with hash h, by double hashing
+    std::size_t probe(std::uint64_t h, std::size_t i) const noexcept {
+        std::uint64_t step = std::rotl(h, 32) | 1;
+        return static_cast<std::size_t>(h + i * step) & (filter.size() * 64 - 1);
+    }
+
+    bool may_contain(std::uint64_t h) const noexcept {
+        if (filter.empty())
+            return false;
+        for (std::size_t i = 0; i < filter_probes; ++i) {
+            auto b = probe(h, i);
+            if ((filter[b / 64] >> (b % 64) & 1) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    void mark(std::uint64_t h) noexcept {
+        for (std::size_t i = 0; i < filter_probes; ++i) {
+            auto b = probe(h, i);
+            filter[b / 64] |= std::uint64_t{1} << (b % 64);
+        }
+    }
+
+    // sizes the filter for n keys, at least doubling it; the keys are hashed again,
+    // which is amortized over the insertions. A failed allocation keeps it as it was
+    void grow_filter(std::size_t n) {
+        std::size_t words = std::bit_ceil(std::max<std::size_t>(n * filter_bits_per_key / 64, 1));
+        if (words <= filter.size())
+            return;
+        vector_type<std::uint64_t> res(words, 0, alloc);
+        filter.swap(res);
+        for (auto const& e : pending)
+            mark(hash_of(*e.first));
+    }
+
+    // adds an entry whose key with hash h is known to be absent
+    void append(K const* k, Mapped const& m, std::uint64_t h) {
+        grow_filter(pending.size() + 1);
+        pending.emplace_back(k, m);
+        try {
+            fingerprints.push_back(fingerprint(h));
+        }
+        catch (...) {
+            pending.pop_back();
+            throw;
+        }
+        mark(h);
+    }
+
+    // whether a pending entry has key k with hash h
+    bool scan(K const& k, std::uint64_t h) const {
+        auto fp = fingerprint(h);
+        for (std::size_t i = 0; i < pending.size(); ++i)
+            if (fingerprints[i] == fp && equivalent(*pending[i].first, k))
+                return true;
+        return false;
+    }
+
+    // whether the pending keys are distinct, given the fingerprints of all keys
+    // the filter reported as possibly repeated; only keys with those are compared
+    bool distinct(vector_type<std::uint32_t>& hits) const {
+        std::ranges::sort(hits);
+        vector_type<std::pair<std::uint32_t, K const*>> suspects(alloc);
+        for (std::size_t i = 0; i < pending.size(); ++i)
+            if (std::ranges::binary_search(hits, fingerprints[i]))
+                suspects.emplace_back(fingerprints[i], pending[i].first);
+        std::ranges::sort(suspects, std::less<>{}, [](auto const& s) { return s.first; });
+        for (std::size_t i = 0; i < suspects.size(); ++i)
+            for (std::size_t j = i + 1; j < suspects.size() && suspects[j].first == suspects[i].first; ++j)
+                if (equivalent(*suspects[i].second, *suspects[j].second))
+                    return false;
+        return true;
+    }
+
+    // the pending entries are copied, so that a failed build leaves them usable
+    void build() const {
+        std::lock_guard lock{build_lock};
+        if (built.load(std::memory_order_relaxed))
+            return;
+        auto entries = pending;
+        Inner res(alloc);
+        res.bulk_insert(entries);
+        index.emplace(std::move(res));
+        built.store(true, std::memory_order_release);
+    }
+
+    Inner& built_index() const {
+        if (!built.load(std::memory_order_acquire))
+            build();
+        return *index;
+    }
+
+    // built index for a modification, which only happens on unshared data,
+    // so the pending entries can go
+    Inner& writable_index() {
+        built_index();
+        if (pending.capacity() != 0) {
+            vector_type<entry>(alloc).swap(pending);
+            vector_type<std::uint32_t>(alloc).swap(fingerprints);
+            vector_type<std::uint64_t>(alloc).swap(filter);
+        }
+        return *index;
+    }
+
+    bool may_be_present(K const& k) const {
+        return built.load(std::memory_order_acquire) || may_contain(hash_of(k));
+    }
+
+    template <typename Rekey>
+    lazy_key_index(std::unique_lock<std::mutex>, lazy_key_index const& rhs, Alloc const& a, Rekey rekey)
+        : index{}, built{rhs.built.load(std::memory_order_relaxed)}, pending(a), fingerprints(a),
+          filter(a), scanned{}, hasher{rhs.hasher}, alloc{a} {
+        if (built) {
+            index.emplace(*rhs.index, a, rekey);
+            return;
+        }
+        pending.reserve(rhs.pending.size());
+        for (auto const& [k, m] : rhs.pending)
+            pending.emplace_back(rekey(m), m);
+        fingerprints = rhs.fingerprints;
+        filter = rhs.filter;
+    }
+
+public:
+
+    // result of locate(), valid until the index is modified
+    struct position {
+        typename Inner::position inner;
+        bool found;
+        // whether the index wasn't built yet, inner is then unset
+        bool unbuilt;
+        // hash of the key while the index isn't built
+        std::uint64_t hash;
+    };
+
+    // the filter only hashes K
+    template <typename Q>
+    static constexpr bool accepts = false;
+
+    explicit lazy_key_index(Alloc const& a = Alloc())
+        : index{}, built{false}, pending(a), fingerprints(a), filter(a), scanned{}, hasher{}, alloc{a} {}
+
+    template <typename Rekey>
+    lazy_key_index(lazy_key_index const& rhs, Alloc const& a, Rekey rekey)
+        : lazy_key_index(std::unique_lock{rhs.build_lock}, rhs, a, rekey) {}
+
+    lazy_key_index(lazy_key_index const&) = delete;
+
+    lazy_key_index(lazy_key_index&& rhs) noexcept(std::is_nothrow_move_constructible_v<Inner>)
+        : index{std::move(rhs.index)}, built{rhs.built.load(std::memory_order_relaxed)},
+          pending{std::move(rhs.pending)}, fingerprints{std::move(rhs.fingerprints)},
+          filter{std::move(rhs.filter)}, scanned{rhs.scanned}, hasher{std::move(rhs.hasher)},
+          alloc{std::move(rhs.alloc)} {}
+
+    Mapped* find(K const& k) {
+        return may_be_present(k) ? built_index().find(k) : nullptr;
+    }
+
+    Mapped const* find(K const& k) const {
+        return may_be_present(k) ? std::as_const(built_index()).find(k) : nullptr;
+    }
+
+    bool contains(K const& k) const {
+        return may_be_present(k) && std::as_const(built_index()).contains(k);
+    }
+
+    // single lookup that serves both a following insert_at() and erase_at();
+    // before the index is built, a key found by a scan builds it
+    position locate(K const& k) {
+        if (!built.load(std::memory_order_acquire)) {
+            auto h = hash_of(k);
+            if (!may_contain(h))
+                return {{}, false, true, h};
+            if (scanned < scan_budget * pending.size()) {
+                scanned += pending.size();
+                if (!scan(k, h))
+                    return {{}, false, true, h};
+            }
+        }
+        auto p = writable_index().locate(k);
+        return {p, p.found, false, 0};
+    }
+
+    Mapped& mapped_at(position const& p) noexcept {
+        return index->mapped_at(p.inner);
+    }
+
+    // p must be the result of locate(*k) and not found; a lookup made since may
+    // have built the index, p is useless to it then
+    void insert_at(position const& p, K const* k, Mapped const& m) {
+        if (!p.unbuilt)
+            index->insert_at(p.inner, k, m);
+        else if (built.load(std::memory_order_relaxed))
+            writable_index().insert(k, m);
+        else
+            append(k, m, p.hash);
+    }
+
+    // p must be found
+    void erase_at(position const& p) noexcept {
+        index->erase_at(p.inner);
+    }
+
+    // drops the n entries appended last and returns true, unless the index is built;
+    // undoes their insertion without allocating
+    bool drop_newest(std::size_t n) noexcept {
+        if (built.load(std::memory_order_relaxed))
+            return false;
+        pending.erase(pending.end() - static_cast<std::ptrdiff_t>(n), pending.end());
+        fingerprints.erase(fingerprints.end() - static_cast<std::ptrdiff_t>(n), fingerprints.end());
+        return true;
+    }
+
+    // moves the found entry at p into dst as (k, m), where *k equals its key
+    // and isn't present in dst; a built dst takes the entry over the way Inner does,
+    // so that neither allocates once dst is reserved
+    void move_entry_at(position const& p, K const* k, Mapped const& m, lazy_key_index& dst) {
+        if (dst.built.load(std::memory_order_relaxed)) {
+            index->move_entry_at(p.inner, k, m, *dst.index);
+            return;
+        }
+        erase_at(p);
+        dst.append(k, m, dst.hash_of(*k));
+    }
+
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
+    // returns false and leaves the index unchanged if *k is already present
+    bool insert(K const* k, Mapped const& m) {
+        auto p = locate(*k);
+        if (p.found)
+            return false;
+        insert_at(p, k, m);
+        return true;
+    }
+
+    void erase(K const& k) {
+        if (!built.load(std::memory_order_acquire)) {
+            // the newest entry, e.g. the front note of a binder filled by insert_front(),
+            // is erased without the index
+            if (!pending.empty() && pending.back().first == &k) {
+                pending.pop_back();
+                fingerprints.pop_back();
+                return;
+            }
+            if (!may_contain(hash_of(k)))
+                return;
+        }
+        writable_index().erase(k);
+    }
+
+    void reserve(std::size_t n) {
+        if (built.load(std::memory_order_relaxed)) {
+            index->reserve(n);
+            return;
+        }
+        pending.reserve(n);
+        fingerprints.reserve(n);
+        grow_filter(n);
+    }
+
+    // entries with keys in [lo, hi) in key order
+    template <typename Q>
+        requires requires(Inner const& i, Q const& q) { i.range(q, q); }
+    auto range(Q const& lo, Q const& hi) const {
+        return std::as_const(built_index()).range(lo, hi);
+    }
+
+    // fills an empty index with entries of distinct keys
+    template <typename Entries>
+    void bulk_insert(Entries& entries) {
+        reserve(entries.size());
+        for (auto const& [k, m] : entries)
+            append(k, m, hash_of(*k));
+    }
+
+    // same as bulk_insert, but returns false if two entries have equal keys,
+    // after which the index is only fit to be destroyed; only keys the filter
+    // reports as possibly repeated are compared
+    template <typename Entries>
+    bool bulk_insert_unique(Entries& entries) {
+        reserve(entries.size());
+        vector_type<std::uint32_t> hits(alloc);
+        for (auto const& [k, m] : entries) {
+            auto h = hash_of(*k);
+            if (may_contain(h))
+                hits.push_back(fingerprint(h));
+            append(k, m, h);
+        }
+        return hits.empty() || distinct(hits);
+    }
+
+    // bytes allocated outside the object
+    std::size_t memory_usage() const noexcept {
+        std::size_t res = pending.capacity() * sizeof(entry) + fingerprints.capacity() * sizeof(std::uint32_t)
+            + filter.capacity() * sizeof(std::uint64_t);
+        if (built.load(std::memory_order_acquire))
+            res += index->memory_usage();
+        return res;
+    }
+
+    std::size_t size() const noexcept {
+        return built.load(std::memory_order_acquire) ? index->size() : pending.size();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+}; // class lazy_key_index
+
+// distinct nonzero numbers marking versions of data, e.g. to tell whether a value
+// was handed out by the current one
+inline std::uint64_t next_generation() noexcept {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// value of a note in a block of its own, shared by the copies of the note
+template <typename V>
+struct shared_value {
+    std::shared_ptr<V> ptr;
+    // generation of the data that last handed out a mutable reference to *ptr
+    std::uint64_t exposed_in;
+};
+
+// note storage backed by std::list, one heap node per note
+template <typename T, typename Alloc = std::allocator<std::byte>>
+class node_list {
+
+    using list_type = std::list<T, rebind_alloc_t<Alloc, T>>;
+
+    list_type list;
+
+public:
+
+    using handle = typename list_type::iterator;
+    using const_iterator = typename list_type::const_iterator;
+
+    static constexpr bool copies_keep_handles = false;
+    static constexpr bool moves_keep_keys = true;
+
+    explicit node_list(Alloc const& a = Alloc()) : list{a} {}
+
+    node_list(node_list const& rhs, Alloc const& a) : list{rhs.list, a} {}
+
+    template <typename... Args>
+    handle emplace_front(Args&&... args) {
+        list.emplace_front(std::forward<Args>(args)...);
+        return list.begin();
+    }
+
+    template <typename... Args>
+    handle emplace_after(handle h, Args&&... args) {
+        return list.emplace(std::next(h), std::forward<Args>(args)...);
+    }
+
+    void erase(handle h) noexcept {
+        list.erase(h);
+    }
+
+    // relinking nodes between lists, whose allocators must compare equal; handles of the
+    // moved nodes stay valid and refer to the list they were moved to
+
+    // moves every node of other after *prev, or to the front if prev is nullptr
+    void splice_after(handle const* prev, node_list& other) noexcept {
+        list.splice((prev == nullptr) ? list.begin() : std::next(*prev), other.list);
+    }
+
+    // moves the nodes following h to the end of other
+    void split_after(handle h, node_list& other) noexcept {
+        other.list.splice(other.list.end(), list, std::next(h), list.end());
+    }
+
+    handle head() noexcept {
+        return list.begin();
+    }
+
+    handle next(handle h) const noexcept {
+        return std::next(h);
+    }
+
+    handle end_handle() noexcept {
+        return list.end();
+    }
+
+    T& get(handle h) const noexcept {
+        return *h;
+    }
+
+    const_iterator iterator_at(handle h) const noexcept {
+        return h;
+    }
+
+    void reserve(std::size_t) noexcept {}
+
+    // bytes allocated outside the object, estimated for a node of two links per note
+    std::size_t memory_usage() const noexcept {
+        return list.size() * (sizeof(T) + 2 * sizeof(void*));
+    }
+
+    std::size_t size() const noexcept {
+        return list.size();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return list.cbegin();
+    }
+
+    const_iterator cend() const noexcept {
+        return list.cend();
+    }
+}; // class node_list
+
+// handles of the notes of a storage copy by the address of the original note, for
+// storages whose copies don't keep handles; open addressing in a single allocation
+template <typename Handle, typename Alloc>
+class handle_map {
+
+    using slot = std::pair<void const*, Handle>;
+
+    std::vector<slot, rebind_alloc_t<Alloc, slot>> slots;
+    std::size_t mask;
+
+    std::size_t start(void const* p) const noexcept {
+        std::uint64_t x = reinterpret_cast<std::uintptr_t>(p) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(x ^ (x >> 32)) & mask;
+    }
+
+public:
+
+    // copy must be a copy of original made since
+    template <typename S>
+    handle_map(S const& original, S& copy, Alloc const& a)
+        : slots(std::bit_ceil(2 * copy.size() + 1), slot{nullptr, Handle{}}, a), mask{slots.size() - 1} {
+        auto o = original.cbegin();
+        for (auto h = copy.head(); h != copy.end_handle(); h = copy.next(h), ++o) {
+            std::size_t i = start(&*o);
+            while (slots[i].first != nullptr)
+                i = (i + 1) & mask;
+            slots[i] = {&*o, h};
+        }
+    }
+
+    // handle in the copy of the note at p, which must be a note of the original
+    Handle operator[](void const* p) const noexcept {
+        std::size_t i = start(p);
+        while (slots[i].first != p)
+            i = (i + 1) & mask;
+        return slots[i].second;
+    }
+}; // class handle_map
+
+// first slab of a slab_list stored inside the list itself
+template <typename Node, std::size_t N>
+struct inline_slab {
+    Node nodes[N];
+
+    Node* data() noexcept {
+        return nodes;
+    }
+};
+
+template <typename Node>
+struct inline_slab<Node, 0> {
+    Node* data() noexcept {
+        return nullptr;
+    }
+};
+
+// note storage keeping nodes in a pool of slabs, linked by 32-bit indices;
+// slab k holds (first slab size) * 2^k nodes and slabs are never moved,
+// so references to stored values stay valid until the node is erased;
+// with InlineNodes != 0 the first slab is a part of the list and holds InlineNodes nodes
+template <typename T, typename Alloc = std::allocator<std::byte>, std::size_t InlineNodes = 0>
+class slab_list {
+
+    static_assert(InlineNodes == 0 || std::has_single_bit(InlineNodes), "inline slab size must be a power of two");
+
+    using index_t = std::uint32_t;
+
+    static constexpr index_t npos = std::numeric_limits<index_t>::max();
+    static constexpr unsigned min_base_shift = 4;
+    static constexpr bool has_inline_slab = InlineNodes != 0;
+
+    struct node {
+        index_t prev;
+        index_t next;
+        union {
+            T value;
+        };
+
+        node() noexcept {}
+        ~node() {}
+    };
+
+    using node_alloc_t = rebind_alloc_t<Alloc, node>;
+
+    [[no_unique_address]] node_alloc_t alloc;
+    [[no_unique_address]] mutable inline_slab<node, InlineNodes> local;
+    // start of every allocated slab, a slab may be a part of a larger block
+    std::vector<node*, rebind_alloc_t<Alloc, node*>> slabs;
+    // allocated blocks of nodes with their sizes
+    std::vector<std::pair<node*, std::size_t>, rebind_alloc_t<Alloc, std::pair<node*, std::size_t>>> blocks;
+    // log2 of the first slab size
+    unsigned base_shift;
+    index_t first;
+    index_t last;
+    // head of the list of erased slots, chained through node::next
+    index_t free_head;
+    // number of slots handed out so far, free or not
+    index_t used;
+    std::size_t count;
+
+    std::size_t slab_count() const noexcept {
+        return slabs.size() + has_inline_slab;
+    }
+
+    node* slab(std::size_t k) const noexcept {
+        if constexpr (has_inline_slab)
+            return (k == 0) ? local.data() : slabs[k - 1];
+        else
+            return slabs[k];
+    }
+
+    node& at(index_t i) const noexcept {
+        std::size_t q = (static_cast<std::size_t>(i) >> base_shift) + 1;
+        std::size_t k = std::bit_width(q) - 1;
+        std::size_t offset = i - ((((std::size_t)1 << k) - 1) << base_shift);
+        return slab(k)[offset];
+    }
+
+    std::size_t capacity() const noexcept {
+        return ((((std::size_t)1) << slab_count()) - 1) << base_shift;
+    }
+
+    node* allocate_block(std::size_t n) {
+        blocks.reserve(blocks.size() + 1);
+        node* p = alloc.allocate(n);
+        std::uninitialized_default_construct_n(p, n);
+        blocks.emplace_back(p, n);
+        return p;
+    }
+
+    void deallocate_blocks() noexcept {
+        for (auto [p, n] : blocks) {
+            std::destroy_n(p, n);
+            alloc.deallocate(p, n);
+        }
+        blocks.clear();
+    }
+
+    void add_slab() {
+        slabs.reserve(slabs.size() + 1);
+        slabs.push_back(allocate_block(((std::size_t)1 << slab_count()) << base_shift));
+    }
+
+    index_t acquire() {
+        if (free_head != npos) {
+            index_t i = free_head;
+            free_head = at(i).next;
+            return i;
+        }
+        if (used == npos)
+            throw std::length_error("binder exceeds maximum number of notes");
+        if (used == capacity())
+            add_slab();
+        return used++;
+    }
+
+    // an erased slot is marked by linking it back to itself
+    void release(index_t i) noexcept {
+        at(i).prev = i;
+        at(i).next = free_head;
+        free_head = i;
+    }
+
+    void link_after(index_t prev, index_t i) noexcept {
+        node& n = at(i);
+        n.prev = prev;
+        n.next = (prev == npos) ? first : at(prev).next;
+        if (n.next == npos)
+            last = i;
+        else
+            at(n.next).prev = i;
+        if (prev == npos)
+            first = i;
+        else
+            at(prev).next = i;
+    }
+
+    template <typename... Args>
+    index_t emplace_at(index_t prev, Args&&... args) {
+        index_t i = acquire();
+        try {
+            std::construct_at(&at(i).value, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            release(i);
+            throw;
+        }
+        link_after(prev, i);
+        ++count;
+        return i;
+    }
+
+    void destroy() noexcept {
+        for (index_t i = first; i != npos; i = at(i).next)
+            std::destroy_at(&at(i).value);
+    }
+
+public:
+
+    using handle = index_t;
+
+    // copies keep the handles of the original
+    static constexpr bool copies_keep_handles = true;
+    // notes of an inline slab are moved one by one, so are the keys in them
+    static constexpr bool moves_keep_keys = !has_inline_slab;
+
+    class const_iterator {
+
+        friend class slab_list;
+
+        slab_list const* owner;
+        index_t pos;
+
+        const_iterator(slab_list const* o, index_t p) noexcept : owner{o}, pos{p} {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T const*;
+        using reference = T const&;
+
+        const_iterator() noexcept : owner{}, pos{npos} {}
+
+        T const& operator*() const noexcept {
+            return owner->at(pos).value;
+        }
+
+        T const* operator->() const noexcept {
+            return &owner->at(pos).value;
+        }
+
+        const_iterator& operator++() noexcept {
+            pos = owner->at(pos).next;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // the end steps back to the last note
+        const_iterator& operator--() noexcept {
+            pos = (pos == npos) ? owner->last : owner->at(pos).prev;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const_iterator const& rhs) const noexcept {
+            return pos == rhs.pos;
+        }
+    }; // class slab_list::const_iterator
+
+    explicit slab_list(Alloc const& a = Alloc()) noexcept
+        : alloc{a}, slabs(alloc), blocks(alloc),
+          base_shift{has_inline_slab ? static_cast<unsigned>(std::countr_zero(InlineNodes)) : min_base_shift},
+          first{npos}, last{npos}, free_head{npos}, used{}, count{} {}
+
+    // the copy keeps every node at the same index, so handles into rhs are valid
+    // handles into the copy; all of its allocated slabs are carved out of a single block
+    slab_list(slab_list const& rhs, Alloc const& a) : slab_list(a) {
+        if (rhs.used == 0)
+            return;
+        base_shift = rhs.base_shift;
+        if (rhs.slabs.size() != 0) {
+            slabs.reserve(rhs.slabs.size());
+            node* block = allocate_block(rhs.capacity() - InlineNodes);
+            for (std::size_t k = has_inline_slab; k < rhs.slab_count(); ++k)
+                slabs.push_back(block + ((((std::size_t)1 << k) - 1) << base_shift) - InlineNodes);
+        }
+        for (index_t i = 0; i < rhs.used; ++i) {
+            at(i).prev = rhs.at(i).prev;
+            at(i).next = rhs.at(i).next;
+        }
+        free_head = rhs.free_head;
+        used = rhs.used;
+        index_t i = rhs.first;
+        try {
+            for (; i != npos; i = rhs.at(i).next)
+                std::construct_at(&at(i).value, rhs.at(i).value);
+        }
+        catch (...) {
+            for (index_t j = rhs.first; j != i; j = rhs.at(j).next)
+                std::destroy_at(&at(j).value);
+            throw;
+        }
+        first = rhs.first;
+        last = rhs.last;
+        count = rhs.count;
+    }
+
+    slab_list(slab_list const& rhs) : slab_list(rhs, rhs.alloc) {}
+
+    // values in the inline slab are moved one by one, the others stay where they are
+    slab_list(slab_list&& rhs) noexcept(!has_inline_slab || std::is_nothrow_move_constructible_v<T>)
+        : alloc{rhs.alloc}, slabs(alloc), blocks(alloc), base_shift{rhs.base_shift},
+          first{npos}, last{npos}, free_head{npos}, used{}, count{} {
+        if constexpr (has_inline_slab) {
+            index_t inline_used = std::min<index_t>(rhs.used, InlineNodes);
+            index_t i = 0;
+            try {
+                for (; i < inline_used; ++i) {
+                    node& src = rhs.local.data()[i];
+                    node& dst = local.data()[i];
+                    if (src.prev != i)
+                        std::construct_at(&dst.value, std::move(src.value));
+                    dst.prev = src.prev;
+                    dst.next = src.next;
+                }
+            }
+            catch (...) {
+                for (index_t j = 0; j < i; ++j)
+                    if (local.data()[j].prev != j)
+                        std::destroy_at(&local.data()[j].value);
+                throw;
+            }
+            for (index_t j = 0; j < inline_used; ++j)
+                if (rhs.local.data()[j].prev != j)
+                    std::destroy_at(&rhs.local.data()[j].value);
+        }
+        slabs = std::move(rhs.slabs);
+        blocks = std::move(rhs.blocks);
+        first = std::exchange(rhs.first, npos);
+        last = std::exchange(rhs.last, npos);
+        free_head = std::exchange(rhs.free_head, npos);
+        used = std::exchange(rhs.used, 0);
+        count = std::exchange(rhs.count, 0);
+        rhs.slabs.clear();
+        rhs.blocks.clear();
+    }
+
+    slab_list& operator=(slab_list const&) = delete;
+    slab_list& operator=(slab_list&&) = delete;
+
+    ~slab_list() noexcept {
+        destroy();
+        deallocate_blocks();
+    }
+
+    template <typename... Args>
+    handle emplace_front(Args&&... args) {
+        return emplace_at(npos, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    handle emplace_after(handle h, Args&&... args) {
+        return emplace_at(h, std::forward<Args>(args)...);
+    }
+
+    void erase(handle h) noexcept {
+        node& n = at(h);
+        if (n.prev == npos)
+            first = n.next;
+        else
+            at(n.prev).next = n.next;
+        if (n.next == npos)
+            last = n.prev;
+        else
+            at(n.next).prev = n.prev;
+        std::destroy_at(&n.value);
+        release(h);
+        --count;
+    }
+
+    handle head() const noexcept {
+        return first;
+    }
+
+    handle next(handle h) const noexcept {
+        return at(h).next;
+    }
+
+    handle end_handle() const noexcept {
+        return npos;
+    }
+
+    T& get(handle h) const noexcept {
+        return at(h).value;
+    }
+
+    const_iterator iterator_at(handle h) const noexcept {
+        return const_iterator(this, h);
+    }
+
+    // number of slots handed out so far, each of them holds a note or is erased
+    std::size_t slot_count() const noexcept {
+        return used;
+    }
+
+    // calls fn on every note held in the slots [lo, hi), in slot order rather than list order
+    template <typename F>
+    void visit_slots(std::size_t lo, std::size_t hi, F&& fn) const {
+        for (std::size_t i = lo; i < hi;) {
+            std::size_t k = std::bit_width((i >> base_shift) + 1) - 1;
+            std::size_t slab_first = (((std::size_t)1 << k) - 1) << base_shift;
+            std::size_t slab_last = std::min(hi, slab_first + ((std::size_t)1 << (k + base_shift)));
+            node const* nodes = slab(k);
+            for (; i < slab_last; ++i) {
+                node const& n = nodes[i - slab_first];
+                if (n.prev != i)
+                    fn(std::as_const(n.value));
+            }
+        }
+    }
+
+    // sizes the first slab to hold n nodes if nothing was allocated yet,
+    // otherwise appends slabs until n nodes fit
+    void reserve(std::size_t n) {
+        if (n > npos)
+            throw std::length_error("binder exceeds maximum number of notes");
+        if (!has_inline_slab && slabs.empty())
+            base_shift = std::max<unsigned>(min_base_shift, std::bit_width(n - (n != 0)));
+        while (capacity() < n)
+            add_slab();
+    }
+
+    // bytes allocated outside the object, free slots included
+    std::size_t memory_usage() const noexcept {
+        return (capacity() - InlineNodes) * sizeof(node)
+            + slabs.capacity() * sizeof(node*) + blocks.capacity() * sizeof(std::pair<node*, std::size_t>);
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, first);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, npos);
+    }
+}; // class slab_list
+
+// notes kept in an implicit treap ordered by position in the list: every node knows
+// its parent and the size of its subtree, so the position of a note and the note at
+// a position are found in O(log n) expected time, at the price of O(log n) insertion
+// and erasure instead of O(1)
+template <typename T, typename Alloc>
+class ranked_list {
+
+    struct node {
+        T value;
+        node* parent;
+        node* left;
+        node* right;
+        std::size_t size;
+        std::uint64_t priority;
+
+        template <typename... Args>
+        explicit node(std::uint64_t p, Args&&... args)
+            : value(std::forward<Args>(args)...), parent{}, left{}, right{}, size{1}, priority{p} {}
+    };
+
+    using node_alloc_t = rebind_alloc_t<Alloc, node>;
+
+    [[no_unique_address]] node_alloc_t alloc;
+    node* root;
+    // state of the generator of priorities
+    std::uint64_t seed;
+
+    static std::size_t size_of(node const* n) noexcept {
+        return (n == nullptr) ? 0 : n->size;
+    }
+
+    static node* leftmost(node* n) noexcept {
+        while (n->left != nullptr)
+            n = n->left;
+        return n;
+    }
+
+    static node* rightmost(node* n) noexcept {
+        while (n->right != nullptr)
+            n = n->right;
+        return n;
+    }
+
+    static node* successor(node* n) noexcept {
+        if (n->right != nullptr)
+            return leftmost(n->right);
+        while (n->parent != nullptr && n == n->parent->right)
+            n = n->parent;
+        return n->parent;
+    }
+
+    static node* predecessor(node* n) noexcept {
+        if (n->left != nullptr)
+            return rightmost(n->left);
+        while (n->parent != nullptr && n == n->parent->left)
+            n = n->parent;
+        return n->parent;
+    }
+
+    // splitmix64
+    std::uint64_t next_priority() noexcept {
+        std::uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    template <typename... Args>
+    node* make_node(Args&&... args) {
+        node* n = alloc.allocate(1);
+        try {
+            std::construct_at(n, next_priority(), std::forward<Args>(args)...);
+        }
+        catch (...) {
+            alloc.deallocate(n, 1);
+            throw;
+        }
+        return n;
+    }
+
+    void drop_node(node* n) noexcept {
+        std::destroy_at(n);
+        alloc.deallocate(n, 1);
+    }
+
+    void destroy(node* n) noexcept {
+        while (n != nullptr) {
+            destroy(n->right);
+            node* left = n->left;
+            drop_node(n);
+            n = left;
+        }
+    }
+
+    // copy of the subtree of src with the same shape and priorities
+    node* clone(node const* src, node* parent) {
+        if (src == nullptr)
+            return nullptr;
+        node* n = alloc.allocate(1);
+        try {
+            std::construct_at(n, src->priority, src->value);
+        }
+        catch (...) {
+            alloc.deallocate(n, 1);
+            throw;
+        }
+        n->parent = parent;
+        n->size = src->size;
+        try {
+            n->left = clone(src->left, n);
+            n->right = clone(src->right, n);
+        }
+        catch (...) {
+            destroy(n->left);
+            drop_node(n);
+            throw;
+        }
+        return n;
+    }
+
+    void replace_child(node* parent, node* old_child, node* new_child) noexcept {
+        if (parent == nullptr)
+            root = new_child;
+        else if (parent->left == old_child)
+            parent->left = new_child;
+        else
+            parent->right = new_child;
+        if (new_child != nullptr)
+            new_child->parent = parent;
+    }
+
+    // moves x above its parent, keeping the order of the list
+    void rotate_up(node* x) noexcept {
+        node* p = x->parent;
+        if (x == p->left) {
+            p->left = x->right;
+            if (x->right != nullptr)
+                x->right->parent = p;
+            x->right = p;
+        }
+        else {
+            p->right = x->left;
+            if (x->left != nullptr)
+                x->left->parent = p;
+            x->left = p;
+        }
+        replace_child(p->parent, p, x);
+        p->parent = x;
+        x->size = p->size;
+        p->size = 1 + size_of(p->left) + size_of(p->right);
+    }
+
+    // hangs the fresh node n under parent and restores the heap order of priorities
+    void attach(node* n, node* parent, bool as_left) noexcept {
+        n->parent = parent;
+        if (parent == nullptr)
+            root = n;
+        else if (as_left)
+            parent->left = n;
+        else
+            parent->right = n;
+        for (node* p = parent; p != nullptr; p = p->parent)
+            ++p->size;
+        while (n->parent != nullptr && n->priority > n->parent->priority)
+            rotate_up(n);
+    }
+
+public:
+
+    using handle = node*;
+
+    static constexpr bool copies_keep_handles = false;
+    static constexpr bool moves_keep_keys = true;
+
+    class const_iterator {
+
+        friend class ranked_list;
+
+        ranked_list const* owner;
+        node* pos;
+
+        const_iterator(ranked_list const* o, node* p) noexcept : owner{o}, pos{p} {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T const*;
+        using reference = T const&;
+
+        const_iterator() noexcept : owner{}, pos{} {}
+
+        T const& operator*() const noexcept {
+            return pos->value;
+        }
+
+        T const* operator->() const noexcept {
+            return &pos->value;
+        }
+
+        const_iterator& operator++() noexcept {
+            pos = successor(pos);
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // the end steps back to the last note
+        const_iterator& operator--() noexcept {
+            pos = (pos == nullptr) ? rightmost(owner->root) : predecessor(pos);
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const_iterator const& rhs) const noexcept {
+            return pos == rhs.pos;
+        }
+    }; // class ranked_list::const_iterator
+
+    explicit ranked_list(Alloc const& a = Alloc()) noexcept : alloc{a}, root{}, seed{} {}
+
+    ranked_list(ranked_list const& rhs, Alloc const& a) : alloc{a}, root{}, seed{rhs.seed} {
+        root = clone(rhs.root, nullptr);
+    }
+
+    ranked_list(ranked_list&& rhs) noexcept
+        : alloc{rhs.alloc}, root{std::exchange(rhs.root, nullptr)}, seed{rhs.seed} {}
+
+    ranked_list& operator=(ranked_list const&) = delete;
+    ranked_list& operator=(ranked_list&&) = delete;
+
+    ~ranked_list() noexcept {
+        destroy(root);
+    }
+
+    template <typename... Args>
+    handle emplace_front(Args&&... args) {
+        node* n = make_node(std::forward<Args>(args)...);
+        if (root == nullptr)
+            attach(n, nullptr, true);
+        else
+            attach(n, leftmost(root), true);
+        return n;
+    }
+
+    // the new node becomes the leftmost node of the right subtree of h
+    template <typename... Args>
+    handle emplace_after(handle h, Args&&... args) {
+        node* n = make_node(std::forward<Args>(args)...);
+        if (h->right == nullptr)
+            attach(n, h, false);
+        else
+            attach(n, leftmost(h->right), true);
+        return n;
+    }
+
+    void erase(handle h) noexcept {
+        while (h->left != nullptr && h->right != nullptr)
+            rotate_up((h->left->priority > h->right->priority) ? h->left : h->right);
+        node* parent = h->parent;
+        replace_child(parent, h, (h->left != nullptr) ? h->left : h->right);
+        for (node* p = parent; p != nullptr; p = p->parent)
+            --p->size;
+        drop_node(h);
+    }
+
+    handle head() const noexcept {
+        return (root == nullptr) ? nullptr : leftmost(root);
+    }
+
+    handle next(handle h) const noexcept {
+        return successor(h);
+    }
+
+    handle end_handle() const noexcept {
+        return nullptr;
+    }
+
+    T& get(handle h) const noexcept {
+        return h->value;
+    }
+
+    const_iterator iterator_at(handle h) const noexcept {
+        return const_iterator(this, h);
+    }
+
+    // number of notes before h
+    std::size_t rank(handle h) const noexcept {
+        std::size_t res = size_of(h->left);
+        for (node* n = h; n->parent != nullptr; n = n->parent)
+            if (n == n->parent->right)
+                res += size_of(n->parent->left) + 1;
+        return res;
+    }
+
+    // note at position i, which must be less than size()
+    handle select(std::size_t i) const noexcept {
+        node* n = root;
+        while (true) {
+            std::size_t left = size_of(n->left);
+            if (i < left) {
+                n = n->left;
+            }
+            else if (i == left) {
+                return n;
+            }
+            else {
+                i -= left + 1;
+                n = n->right;
+            }
+        }
+    }
+
+    // nodes are allocated one by one
+    void reserve(std::size_t) noexcept {}
+
+    std::size_t memory_usage() const noexcept {
+        return size() * sizeof(node);
+    }
+
+    std::size_t size() const noexcept {
+        return size_of(root);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, head());
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, nullptr);
+    }
+}; // class ranked_list
+
+// storages that find the position of a note and the note at a position quickly
+template <typename S>
+concept order_statistic_storage = requires(S const& s, typename S::handle h, std::size_t i) {
+    { s.rank(h) } -> std::convertible_to<std::size_t>;
+    { s.select(i) } -> std::same_as<typename S::handle>;
+};
+
+// persistent list of notes kept in a path-copying treap ordered by key; each node
+// stores the keys of its neighbours in note order, so every list operation is a
+// constant number of O(log n) tree updates. Copies share all nodes; a mutation first
+// copies the nodes on the paths it touches that another version still uses and then
+// updates the path in place, so an unshared list allocates only the new note. Iterator
+// steps look the neighbouring key up, O(log n) each. Values are shared between versions
+// and copied only when handed out for writing.
+template <typename K, typename V, typename Alloc = std::allocator<std::byte>>
+class persistent_list {
+
+    struct node;
+    using node_ptr = std::shared_ptr<node>;
+
+    struct node {
+        K key;
+        std::shared_ptr<V> value;
+        std::optional<K> prev;
+        std::optional<K> next;
+        // generation of the list that last handed out a mutable reference to value
+        std::uint64_t exposed_in;
+        std::uint32_t priority;
+        node_ptr left;
+        node_ptr right;
+    };
+
+    [[no_unique_address]] Alloc alloc;
+    node_ptr root;
+    std::optional<K> first;
+    std::optional<K> last;
+    std::size_t count;
+    // distinguishes this version from every other one, changes on each mutation
+    std::uint64_t generation;
+    // keys whose values were handed out by expose() since the last mutation
+    std::vector<K, rebind_alloc_t<Alloc, K>> exposed;
+
+    static std::uint32_t random_priority() noexcept {
+        thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<std::uint32_t>(z ^ (z >> 31));
+    }
+
+    // makes t point to a node not shared with any other version
+    void own(node_ptr& t) {
+        if (t.use_count() != 1)
+            t = std::allocate_shared<node>(alloc, *t);
+    }
+
+    template <typename Q>
+    static node const* find_node(node_ptr const& t, Q const& k) noexcept {
+        node const* n = t.get();
+        while (n != nullptr) {
+            if (k < n->key)
+                n = n->left.get();
+            else if (n->key < k)
+                n = n->right.get();
+            else
+                return n;
+        }
+        return nullptr;
+    }
+
+    // copies the path to k where it is shared and returns the now private node;
+    // k must be present
+    node* locate_owned(node_ptr& t, K const& k) {
+        node_ptr* slot = &t;
+        while (true) {
+            own(*slot);
+            node& n = **slot;
+            if (k < n.key)
+                slot = &n.left;
+            else if (n.key < k)
+                slot = &n.right;
+            else
+                return &n;
+        }
+    }
+
+    // copies the nodes on the search path of k where they are shared, which leaves the
+    // tree as it was; inserting a node with key k only touches that path afterwards
+    void own_path(node_ptr& t, K const& k) {
+        node_ptr* slot = &t;
+        while (*slot != nullptr) {
+            own(*slot);
+            node& n = **slot;
+            if (k < n.key)
+                slot = &n.left;
+            else if (n.key < k)
+                slot = &n.right;
+            else
+                return;
+        }
+    }
+
+    // same for the path of a present k and the spines of its subtrees that merge() visits
+    // when the node is erased
+    void own_erase_path(node_ptr& t, K const& k) {
+        node* n = locate_owned(t, k);
+        for (node_ptr* slot = &n->left; *slot != nullptr; slot = &(*slot)->right)
+            own(*slot);
+        for (node_ptr* slot = &n->right; *slot != nullptr; slot = &(*slot)->left)
+            own(*slot);
+    }
+
+    // splits t into the nodes with keys less than and greater than k
+    std::pair<node_ptr, node_ptr> split(node_ptr t, K const& k) {
+        if (t == nullptr)
+            return {};
+        own(t);
+        if (t->key < k) {
+            auto [l, r] = split(std::move(t->right), k);
+            t->right = std::move(l);
+            return {std::move(t), std::move(r)};
+        }
+        auto [l, r] = split(std::move(t->left), k);
+        t->left = std::move(r);
+        return {std::move(l), std::move(t)};
+    }
+
+    // joins a and b, every key in a is less than every key in b
+    node_ptr merge(node_ptr a, node_ptr b) {
+        if (a == nullptr)
+            return b;
+        if (b == nullptr)
+            return a;
+        if (a->priority > b->priority) {
+            own(a);
+            a->right = merge(std::move(a->right), std::move(b));
+            return a;
+        }
+        own(b);
+        b->left = merge(std::move(a), std::move(b->left));
+        return b;
+    }
+
+    void insert_node(node_ptr& t, node_ptr n) {
+        if (t == nullptr) {
+            t = std::move(n);
+            return;
+        }
+        if (n->priority > t->priority) {
+            auto [l, r] = split(std::move(t), n->key);
+            n->left = std::move(l);
+            n->right = std::move(r);
+            t = std::move(n);
+            return;
+        }
+        own(t);
+        node_ptr& child = (n->key < t->key) ? t->left : t->right;
+        insert_node(child, std::move(n));
+    }
+
+    void erase_node(node_ptr& t, K const& k) {
+        node_ptr* slot = &t;
+        while (true) {
+            node& n = **slot;
+            if (k < n.key || n.key < k) {
+                own(*slot);
+                slot = (k < (*slot)->key) ? &(*slot)->left : &(*slot)->right;
+                continue;
+            }
+            // children of a node still used by another version must not be moved out
+            node_ptr l, r;
+            if (slot->use_count() == 1) {
+                l = std::move(n.left);
+                r = std::move(n.right);
+            }
+            else {
+                l = n.left;
+                r = n.right;
+            }
+            *slot = merge(std::move(l), std::move(r));
+            return;
+        }
+    }
+
+    template <typename KK, typename... Args>
+    node_ptr make_node(std::optional<K> const& prev, std::optional<K> const& next, KK&& k, Args&&... args) const {
+        auto value = std::allocate_shared<V>(alloc, std::forward<Args>(args)...);
+        return std::allocate_shared<node>(alloc,
+            node{std::forward<KK>(k), std::move(value), prev, next, 0, random_priority(), {}, {}});
+    }
+
+    // completes a modification of the tree, never throws
+    void commit(std::optional<K>&& new_first, std::optional<K>&& new_last, std::size_t new_count) noexcept {
+        first = std::move(new_first);
+        last = std::move(new_last);
+        count = new_count;
+        exposed.clear();
+        generation = next_generation();
+    }
+
+public:
+
+    class const_iterator {
+
+        friend class persistent_list;
+
+        persistent_list const* owner;
+        node const* pos;
+
+        const_iterator(persistent_list const* o, node const* p) noexcept : owner{o}, pos{p} {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = V;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() noexcept : owner{}, pos{} {}
+
+        K const& key() const noexcept {
+            return pos->key;
+        }
+
+        V const& value() const noexcept {
+            return *pos->value;
+        }
+
+        const_iterator& operator++() noexcept {
+            pos = pos->next ? find_node(owner->root, *pos->next) : nullptr;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // the end steps back to the last note
+        const_iterator& operator--() noexcept {
+            auto const& prev = (pos == nullptr) ? owner->last : pos->prev;
+            pos = prev ? find_node(owner->root, *prev) : nullptr;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator==(const_iterator const& rhs) const noexcept {
+            return pos == rhs.pos;
+        }
+    }; // class persistent_list::const_iterator
+
+    explicit persistent_list(Alloc const& a = Alloc()) noexcept
+        : alloc{a}, root{}, first{}, last{}, count{}, generation{next_generation()}, exposed(a) {}
+
+    // O(1) apart from values that were handed out by expose(), which the copy
+    // must not alias; nodes shared with rhs stay in the memory rhs allocated them in
+    persistent_list(persistent_list const& rhs, Alloc const& a)
+        : alloc{a}, root{rhs.root}, first{rhs.first}, last{rhs.last}, count{rhs.count},
+          generation{next_generation()}, exposed(a) {
+        for (auto const& k : rhs.exposed) {
+            node* n = locate_owned(root, k);
+            n->value = std::allocate_shared<V>(alloc, *n->value);
+        }
+    }
+
+    persistent_list(persistent_list const& rhs) : persistent_list(rhs, rhs.alloc) {}
+
+    persistent_list(persistent_list&& rhs) noexcept
+        : alloc{rhs.alloc}, root{std::move(rhs.root)}, first{std::move(rhs.first)}, last{std::move(rhs.last)},
+          count{std::exchange(rhs.count, 0)}, generation{rhs.generation}, exposed{std::move(rhs.exposed)} {}
+
+    persistent_list& operator=(persistent_list const&) = delete;
+    persistent_list& operator=(persistent_list&&) = delete;
+
+    Alloc get_allocator() const noexcept {
+        return alloc;
+    }
+
+    // the current version as it is, nodes and values stay shared with it
+    struct saved_version {
+        node_ptr root;
+        std::optional<K> first;
+        std::optional<K> last;
+        std::size_t count;
+        std::uint64_t generation;
+        std::vector<K, rebind_alloc_t<Alloc, K>> exposed;
+    };
+
+    // O(1) apart from the exposed keys
+    saved_version save() const {
+        return {root, first, last, count, generation, exposed};
+    }
+
+    // reinstates a version saved from this list, undoing every modification since;
+    // references handed out by expose() before save() are valid again
+    void restore(saved_version&& v) noexcept {
+        root = std::move(v.root);
+        first = std::move(v.first);
+        last = std::move(v.last);
+        count = v.count;
+        generation = v.generation;
+        exposed.swap(v.exposed);
+    }
+
+    // both lists must use equal allocators
+    void swap(persistent_list& rhs) noexcept {
+        using std::swap;
+        swap(root, rhs.root);
+        swap(first, rhs.first);
+        swap(last, rhs.last);
+        swap(count, rhs.count);
+        swap(generation, rhs.generation);
+        exposed.swap(rhs.exposed);
+    }
+
+    template <typename Q>
+    bool contains(Q const& k) const noexcept {
+        return find_node(root, k) != nullptr;
+    }
+
+    template <typename Q>
+    V const* find(Q const& k) const noexcept {
+        node const* n = find_node(root, k);
+        return (n == nullptr) ? nullptr : n->value.get();
+    }
+
+    // cend() if k is absent
+    template <typename Q>
+    const_iterator iterator_at(Q const& k) const noexcept {
+        return const_iterator(this, find_node(root, k));
+    }
+
+    // the key equal to k as stored in the current version, nullptr if absent;
+    // stays valid while this version is alive, including during a modification
+    template <typename Q>
+    K const* stored_key(Q const& k) const noexcept {
+        node const* n = find_node(root, k);
+        return (n == nullptr) ? nullptr : &n->key;
+    }
+
+    // returns a reference that stays private to this version, or nullptr if k is absent
+    V* expose(K const& k) {
+        if (!contains(k))
+            return nullptr;
+        node* n = locate_owned(root, k);
+        if (n->value.use_count() != 1)
+            n->value = std::allocate_shared<V>(alloc, *n->value);
+        if (n->exposed_in != generation) {
+            exposed.push_back(k);
+            n->exposed_in = generation;
+        }
+        return n->value.get();
+    }
+
+    // the modifications copy the keys and the shared nodes they need before changing
+    // anything, the rest only moves keys and pointers; a failure changes nothing
+
+    // k must be absent
+    template <typename KK, typename... Args>
+    void emplace_front(KK&& k, Args&&... args) {
+        auto n = make_node(std::nullopt, first, std::forward<KK>(k), std::forward<Args>(args)...);
+        std::optional<K> new_first{n->key};
+        std::optional<K> new_last = last ? last : new_first;
+        std::optional<K> first_prev{n->key};
+        node* f = first ? locate_owned(root, *first) : nullptr;
+        own_path(root, n->key);
+        if (f != nullptr)
+            f->prev = std::move(first_prev);
+        insert_node(root, std::move(n));
+        commit(std::move(new_first), std::move(new_last), count + 1);
+    }
+
+    // prev_k must be present and k absent
+    template <typename KK, typename... Args>
+    void emplace_after(K const& prev_k, KK&& k, Args&&... args) {
+        std::optional<K> next = find_node(root, prev_k)->next;
+        auto n = make_node(prev_k, next, std::forward<KK>(k), std::forward<Args>(args)...);
+        std::optional<K> new_first = first;
+        std::optional<K> new_last = next ? last : std::optional<K>{n->key};
+        std::optional<K> prev_next{n->key};
+        std::optional<K> next_prev{n->key};
+        node* p = locate_owned(root, prev_k);
+        node* q = next ? locate_owned(root, *next) : nullptr;
+        own_path(root, n->key);
+        p->next = std::move(prev_next);
+        if (q != nullptr)
+            q->prev = std::move(next_prev);
+        insert_node(root, std::move(n));
+        commit(std::move(new_first), std::move(new_last), count + 1);
+    }
+
+    // k must be present, it may refer to the key in the note or to first
+    void erase(K const& k) {
+        node const* n = find_node(root, k);
+        std::optional<K> new_first = n->prev ? first : n->next;
+        std::optional<K> new_last = n->next ? last : n->prev;
+        std::optional<K> prev_next = n->next;
+        std::optional<K> next_prev = n->prev;
+        node* p = n->prev ? locate_owned(root, *n->prev) : nullptr;
+        node* q = n->next ? locate_owned(root, *n->next) : nullptr;
+        own_erase_path(root, k);
+        if (p != nullptr)
+            p->next = std::move(prev_next);
+        if (q != nullptr)
+            q->prev = std::move(next_prev);
+        erase_node(root, k);
+        commit(std::move(new_first), std::move(new_last), count - 1);
+    }
+
+    K const& front() const noexcept {
+        return *first;
+    }
+
+    // key of the note following k, k must be present
+    std::optional<K> const& next_of(K const& k) const noexcept {
+        return find_node(root, k)->next;
+    }
+
+    // bytes held by the versions' tree nodes and values as if none of them were shared
+    // with another version, estimated for a control block of two words per allocation
+    std::size_t memory_usage() const noexcept {
+        return count * (sizeof(node) + sizeof(V) + 4 * sizeof(void*)) + exposed.capacity() * sizeof(K);
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, first ? find_node(root, *first) : nullptr);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, nullptr);
+    }
+}; // class persistent_list
+
+// shared_ptr-like owner of a T allocated together with its reference count, a single
+// pointer in size; with Atomic == false copies must not be used from different threads
+template <typename T, typename Alloc, bool Atomic>
+class counted_ptr {
+
+    using count_type = std::conditional_t<Atomic, std::atomic<std::size_t>, std::size_t>;
+
+    struct block {
+        [[no_unique_address]] rebind_alloc_t<Alloc, block> alloc;
+        count_type refs;
+        T value;
+
+        template <typename... Args>
+        explicit block(Alloc const& a, Args&&... args)
+            : alloc{a}, refs{1}, value(std::forward<Args>(args)...) {}
+    };
+
+    using block_traits = std::allocator_traits<rebind_alloc_t<Alloc, block>>;
+
+    block* ptr;
+
+    explicit counted_ptr(block* b) noexcept : ptr{b} {}
+
+    void release() noexcept {
+        if (ptr == nullptr)
+            return;
+        bool last;
+        if constexpr (Atomic)
+            last = ptr->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        else
+            last = --ptr->refs == 0;
+        if (last) {
+            auto a = ptr->alloc;
+            std::destroy_at(ptr);
+            block_traits::deallocate(a, ptr, 1);
+        }
+    }
+
+public:
+
+    counted_ptr() noexcept : ptr{} {}
+
+    counted_ptr(std::nullptr_t) noexcept : ptr{} {}
+
+    counted_ptr(counted_ptr const& rhs) noexcept : ptr{rhs.ptr} {
+        if (ptr == nullptr)
+            return;
+        if constexpr (Atomic)
+            ptr->refs.fetch_add(1, std::memory_order_relaxed);
+        else
+            ++ptr->refs;
+    }
+
+    counted_ptr(counted_ptr&& rhs) noexcept : ptr{std::exchange(rhs.ptr, nullptr)} {}
+
+    counted_ptr& operator=(counted_ptr rhs) noexcept {
+        std::swap(ptr, rhs.ptr);
+        return *this;
+    }
+
+    ~counted_ptr() noexcept {
+        release();
+    }
+
+    template <typename... Args>
+    static counted_ptr allocate(Alloc const& a, Args&&... args) {
+        rebind_alloc_t<Alloc, block> block_alloc(a);
+        block* b = block_traits::allocate(block_alloc, 1);
+        try {
+            std::construct_at(b, a, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            block_traits::deallocate(block_alloc, b, 1);
+            throw;
+        }
+        return counted_ptr(b);
+    }
+
+    T* get() const noexcept {
+        return (ptr == nullptr) ? nullptr : &ptr->value;
+    }
+
+    T& operator*() const noexcept {
+        return ptr->value;
+    }
+
+    T* operator->() const noexcept {
+        return &ptr->value;
+    }
+
+    // acquire, so that a thread seeing 1 also sees everything done through released copies
+    long use_count() const noexcept {
+        if (ptr == nullptr)
+            return 0;
+        if constexpr (Atomic)
+            return static_cast<long>(ptr->refs.load(std::memory_order_acquire));
+        else
+            return static_cast<long>(ptr->refs);
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr != nullptr;
+    }
+
+    friend bool operator==(counted_ptr const& p, std::nullptr_t) noexcept {
+        return p.ptr == nullptr;
+    }
+}; // class counted_ptr
+
+template <typename T, typename Alloc>
+using local_shared_ptr = counted_ptr<T, Alloc, false>;
+
+template <typename T, typename Alloc>
+using intrusive_shared_ptr = counted_ptr<T, Alloc, true>;
+
+// storage whose slots can be scanned in parallel without following the links
+template <typename S>
+concept slot_storage = requires(S const& s) {
+    { s.slot_count() } -> std::convertible_to<std::size_t>;
+};
+
+// storages whose nodes can be relinked into another storage of the same type
+template <typename S>
+concept splicing_storage = requires(S& s, S& other, typename S::handle h) {
+    s.splice_after(&h, other);
+    s.split_after(h, other);
+};
+
+// calls task(i) for every i in [0, parts), part 0 on the calling thread and the rest
+// on threads of their own; rethrows the exception of the lowest failed part
+template <typename F>
+void run_parallel(std::size_t parts, F const& task) {
+    std::vector<std::exception_ptr> errors(parts);
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(parts - 1);
+        for (std::size_t i = 1; i < parts; ++i) {
+            workers.emplace_back([&task, &errors, i] {
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        try {
+            task(0);
+        }
+        catch (...) {
+            errors[0] = std::current_exception();
+        }
+    }
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+// deep copy of shared data P being made by an executor; the copy reads the data through
+// a plain pointer, which isn't counted as a reference, so the owner of p must keep the
+// data alive and unmodified until the copy is taken or dropped, both of which wait for
+// it to finish
+template <typename P>
+class prefetched_clone {
+
+    using source_pointer = decltype(std::declval<P const&>().get());
+
+    source_pointer source = nullptr;
+    std::future<P> result;
+
+public:
+
+    prefetched_clone() = default;
+
+    prefetched_clone(prefetched_clone&& rhs) noexcept
+        : source{std::exchange(rhs.source, nullptr)}, result{std::move(rhs.result)} {}
+
+    prefetched_clone& operator=(prefetched_clone&& rhs) noexcept {
+        reset();
+        source = std::exchange(rhs.source, nullptr);
+        result = std::move(rhs.result);
+        return *this;
+    }
+
+    ~prefetched_clone() {
+        reset();
+    }
+
+    bool prepared_from(P const& p) const noexcept {
+        return source != nullptr && source == p.get();
+    }
+
+    // runs clone(*p) on Executor
+    template <typename Executor, typename Clone>
+    void start(P const& p, Clone clone) {
+        reset();
+        auto promise = std::make_shared<std::promise<P>>();
+        auto future = promise->get_future();
+        Executor::execute([promise, clone = std::move(clone), data = p.get()]() mutable {
+            try {
+                promise->set_value(clone(*data));
+            }
+            catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        source = p.get();
+        result = std::move(future);
+    }
+
+    // the copy of p, once it is finished; nullptr if none was started from p or it failed
+    P take(P const& p) {
+        if (!prepared_from(p))
+            return nullptr;
+        auto f = std::move(result);
+        source = nullptr;
+        try {
+            return f.get();
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+
+    // drops the copy, waiting for it to finish if it's running
+    void reset() noexcept {
+        if (result.valid())
+            result.wait();
+        source = nullptr;
+        result = {};
+    }
+}; // class prefetched_clone
+
+struct no_prefetched_clone {
+    void reset() noexcept {}
+};
+
+} // namespace detail
+
+// key index policies for binder
+
+// std::map index, requires K to be ordered by operator<
+struct ordered_index {
+    template <typename K, typename Mapped, typename Alloc>
+    using type = detail::ordered_map_index<K, Mapped, Alloc>;
+};
+
+// open-addressing hash index, requires std::hash<K> and operator==
+struct hash_index {
+    template <typename K, typename Mapped, typename Alloc>
+    using type = detail::flat_hash_index<K, Mapped, Alloc>;
+};
+
+// hash index with the given hasher and key equality; when both are transparent,
+// read(), remove() and contains() accept any key type they accept
+template <typename Hash, typename Equal = std::equal_to<>>
+struct custom_hash_index {
+    template <typename K, typename Mapped, typename Alloc>
+    using type = detail::flat_hash_index<K, Mapped, Alloc, Hash, Equal>;
+};
+
+// transparent hasher of std::string keys, consistent with std::hash<std::string>;
+// with custom_hash_index<string_hash>, std::string_view and char const* look keys up
+// without a temporary std::string
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+// packed key array for integral, enum and pointer keys while a binder holds at most
+// Threshold notes, Large afterwards; other keys use Large from the start
+template <std::size_t Threshold = 64, typename Large = hash_index>
+struct small_index {
+    template <typename K, typename Mapped, typename Alloc>
+    using type = typename detail::select_small_index<K, Mapped, Alloc, Threshold,
+        typename Large::template type<K, Mapped, Alloc>>::type;
+};
+
+// builds the index of Inner only on the first lookup of a key that may be present;
+// binders that are only filled by insert_front() and iterated pay about 23 bytes per note
+// for an array of entries and a Bloom filter instead. Keys are hashed by Hash,
+// std::hash<K> if void
+template <typename Inner = ordered_index, typename Hash = void>
+struct lazy_index {
+    template <typename K, typename Mapped, typename Alloc>
+    using type = detail::lazy_key_index<K, Mapped, Alloc, typename Inner::template type<K, Mapped, Alloc>,
+        std::conditional_t<std::is_void_v<Hash>, std::hash<K>, Hash>>;
+};
+
+// value policies for binder
+
+// values are held in the notes, a clone of the data copies every value
+struct inline_values {
+    static constexpr bool shared = false;
+};
+
+// every value is held in a block of its own that clones of the data share, so a clone
+// copies keys and pointers only and a value is copied on its first modification;
+// persistent_storage always shares values this way and takes inline_values only
+struct shared_values {
+    static constexpr bool shared = true;
+};
+
+// note storage policies for binder
+
+// one std::list node per note
+struct list_storage {
+    template <typename T, typename Alloc>
+    using type = detail::node_list<T, Alloc>;
+};
+
+// notes pooled in slabs and linked by 32-bit indices, at most 2^32 - 1 notes
+struct slab_storage {
+    template <typename T, typename Alloc>
+    using type = detail::slab_list<T, Alloc>;
+};
+
+// slab storage whose first slab of N notes, rounded up to a power of two, is a part of
+// the binder's shared block, so that a binder of up to N notes allocates nothing else
+template <std::size_t N>
+struct inline_slab_storage {
+    template <typename T, typename Alloc>
+    using type = detail::slab_list<T, Alloc, std::bit_ceil(N)>;
+};
+
+// one tree node per note, augmented with subtree sizes, so that at_position() and
+// position_of() take O(log n) instead of O(n); insertions and removals take O(log n)
+struct ranked_storage {
+    template <typename T, typename Alloc>
+    using type = detail::ranked_list<T, Alloc>;
+};
+
+// immutable notes shared between copies, a mutation of a shared binder copies
+// O(log n) tree nodes instead of the whole binder and one of an unshared binder
+// none; iterators take O(log n) per step. Requires K to be ordered by operator<,
+// the index policy is not used
+struct persistent_storage {};
+
+// reference counting policies for the data shared between copies of a binder
+
+// std::shared_ptr, copies of one binder may live in different threads
+struct atomic_refcount {
+    static constexpr bool thread_safe = true;
+
+    template <typename T, typename Alloc>
+    using pointer = std::shared_ptr<T>;
+
+    template <typename T, typename Alloc, typename... Args>
+    static std::shared_ptr<T> make(Alloc const& a, Args&&... args) {
+        return std::allocate_shared<T>(a, std::forward<Args>(args)...);
+    }
+};
+
+// intrusive non-atomic count, copying a binder costs a plain increment;
+// a binder and all of its copies must stay within one thread
+struct local_refcount {
+    static constexpr bool thread_safe = false;
+
+    template <typename T, typename Alloc>
+    using pointer = detail::local_shared_ptr<T, Alloc>;
+
+    template <typename T, typename Alloc, typename... Args>
+    static detail::local_shared_ptr<T, Alloc> make(Alloc const& a, Args&&... args) {
+        return detail::local_shared_ptr<T, Alloc>::allocate(a, std::forward<Args>(args)...);
+    }
+};
+
+// intrusive atomic count, thread-safe like atomic_refcount, but a binder is a single
+// pointer and its data is allocated without a separate control block
+struct intrusive_refcount {
+    static constexpr bool thread_safe = true;
+
+    template <typename T, typename Alloc>
+    using pointer = detail::intrusive_shared_ptr<T, Alloc>;
+
+    template <typename T, typename Alloc, typename... Args>
+    static detail::intrusive_shared_ptr<T, Alloc> make(Alloc const& a, Args&&... args) {
+        return detail::intrusive_shared_ptr<T, Alloc>::allocate(a, std::forward<Args>(args)...);
+    }
+};
+
+// tracing policies, told about every deep copy of the data of a binder;
+// a tracer with enabled == true provides
+//     static void on_clone(clone_event const&) noexcept
+// which runs synchronously in the thread, and under the call, that caused the copy,
+// or on the clone executor for copies started by binder::prefetch_unshare()
+
+// no tracing, the clock is never read
+struct no_tracer {
+    static constexpr bool enabled = false;
+};
+
+// executors of the deep copies started by binder::prefetch_unshare(); an executor
+// with enabled == true provides
+//     template <typename F> static void execute(F&& task)
+// which calls task() once, on any thread, possibly after execute has returned
+
+// prefetch_unshare() is not available
+struct no_clone_executor {
+    static constexpr bool enabled = false;
+};
+
+// a detached thread for every copy; copies still running when the program exits
+// are abandoned, so they mustn't be started during shutdown
+struct thread_clone_executor {
+    static constexpr bool enabled = true;
+
+    template <typename F>
+    static void execute(F&& task) {
+        std::thread(std::forward<F>(task)).detach();
+    }
+};
+
+// default configuration of binder; derive from it and override members
+// to select other policies
+struct default_binder_traits {
+    using index = ordered_index;
+    using storage = list_storage;
+    using values = inline_values;
+    using refcount = atomic_refcount;
+    using tracer = no_tracer;
+    using clone_executor = no_clone_executor;
+    // rebound for every allocation of a binder: its shared block, notes and index
+    using allocator_type = std::allocator<std::byte>;
+};
+
+// result of binder::try_insert_front and binder::try_insert_after
+enum class insert_status {
+    inserted,
+    key_exists,
+    previous_missing
+};
+
+// cause of a deep copy of the data of a binder
+enum class clone_reason {
+    // copy of a binder that called non-const read() or holds a write handle
+    copy,
+    // modification of a binder whose data is shared
+    write
+};
+
+// deep copy reported to a tracer
+struct clone_event {
+    clone_reason reason;
+    // number of copied notes
+    std::size_t notes;
+    // time spent allocating and copying
+    std::chrono::nanoseconds duration;
+};
+
+// numbers of deep copies made by all binders so far
+struct clone_counters {
+    std::atomic<std::uint64_t> on_copy{0};
+    std::atomic<std::uint64_t> on_write{0};
+};
+
+inline clone_counters global_clone_counters;
+
+// called after every deep copy with its cause and the number of copied notes,
+// possibly from many threads at once
+using clone_hook_t = void (*)(clone_reason, std::size_t) noexcept;
+
+inline std::atomic<clone_hook_t> clone_hook{nullptr};
+
+inline void set_clone_hook(clone_hook_t hook) noexcept {
+    clone_hook.store(hook, std::memory_order_release);
+}
+
+// result of binder::stats(); shared data is counted in full by every binder sharing it
+struct binder_stats {
+    std::size_t notes;
+    // bytes allocated for the notes and their links
+    std::size_t storage_bytes;
+    // bytes allocated for the key index
+    std::size_t index_bytes;
+    // the above together with the shared block and the binder itself
+    std::size_t total_bytes;
+    double bytes_per_note;
+    // number of binders sharing the data, 0 for an empty binder
+    long use_count;
+    // deep copies made along the history of the data
+    std::size_t deep_copies;
+};
+
+// tag selecting the range constructor of binder; std::from_range_t where the
+// standard library provides it
+#if defined(__cpp_lib_containers_ranges)
+using std::from_range_t;
+using std::from_range;
+#else
+struct from_range_t {
+    explicit from_range_t() = default;
+};
+inline constexpr from_range_t from_range{};
+#endif
+
+namespace detail {
+
+// input range of pair-like elements from which notes of binder<K, V> can be made
+template <typename R, typename K, typename V>
+concept note_range = std::ranges::input_range<R> && requires(std::ranges::range_reference_t<R> e) {
+    K(std::get<0>(std::forward<decltype(e)>(e)));
+    V(std::get<1>(std::forward<decltype(e)>(e)));
+};
+
+} // namespace detail
+
+template <typename K, typename V, typename Traits = default_binder_traits>
+class binder;
+
+// configuration for binders that mostly hold at most N notes: their notes and,
+// for integral, enum and pointer keys, their index live inside the shared block,
+// so the first insertion is a single allocation
+template <std::size_t N>
+struct small_binder_traits : default_binder_traits {
+    using index = small_index<N, hash_index>;
+    using storage = inline_slab_storage<N>;
+};
+
+template <typename K, typename V, std::size_t N = 2>
+using small_binder = binder<K, V, small_binder_traits<N>>;
+
+// configuration for binders stored in bulk: a binder is a single pointer
+struct compact_binder_traits : default_binder_traits {
+    using refcount = intrusive_refcount;
+};
+
 template <typename K, typename V>
+using compact_binder = binder<K, V, compact_binder_traits>;
+
+namespace pmr {
+
+// binder whose memory comes from a std::pmr::memory_resource
+struct binder_traits : default_binder_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+template <typename K, typename V>
+using binder = cxx::binder<K, V, binder_traits>;
+
+} // namespace pmr
+
+template <typename K, typename V, typename Traits>
 class binder {
 
-    class binder_data;
+    // part of the shared block describing its sharing, never carried over to a copy;
+    // read_called and writers are only set while the block is unique
+    struct share_state {
+        // whether a non-const reference returned by read() may still be in use
+        bool read_called = false;
+        // number of live write handles
+        std::size_t writers = 0;
+        // number of deep copies that led to this block, kept for stats()
+        std::size_t deep_copies = 0;
+
+        share_state() noexcept = default;
+
+        share_state(share_state const& rhs) noexcept : deep_copies{rhs.deep_copies + 1} {}
+
+        share_state& operator=(share_state const&) = delete;
+
+        void pin() noexcept {
+            ++writers;
+        }
+
+        void unpin() noexcept {
+            --writers;
+        }
+
+        bool pinned() const noexcept {
+            return writers != 0;
+        }
+    };
+
+    class linked_data;
+    class persistent_data;
+
+    // representation of the notes, shared between copies of the binder
+    using binder_data = std::conditional_t<std::is_same_v<typename Traits::storage, persistent_storage>,
+        persistent_data, linked_data>;
+
+    using refcount = typename Traits::refcount;
+    using tracer = typename Traits::tracer;
+    using clone_executor = typename Traits::clone_executor;
+
+    // least number of notes worth a thread of their own in for_each_parallel
+    static constexpr std::size_t parallel_grain = 4096;
+
+    // owning pointer to the shared data, as chosen by the refcount policy
+    using data_pointer = typename refcount::template pointer<binder_data, typename Traits::allocator_type>;
+
+    // data_ptr == nullptr indicates empty binder
+    data_pointer data_ptr;
+
+    // deep copy of data_ptr started by prefetch_unshare(), if any
+    [[no_unique_address]] std::conditional_t<clone_executor::enabled,
+        detail::prefetched_clone<data_pointer>, detail::no_prefetched_clone> prefetched;
+
+    // whether p is referenced by no binder other than its owner, not counting the
+    // references of its write handles; a pinned block is never shared
+    static bool held_alone(data_pointer const& p) noexcept {
+        return p != nullptr && p.use_count() == 1 + static_cast<long>(p->writers);
+    }
+
+    // whether copies must not share the data, because of a reference returned by read()
+    // or a live write handle
+    bool unshareable() const noexcept {
+        return data_ptr != nullptr && (data_ptr->read_called || data_ptr->pinned());
+    }
+
+    // installs the result of a modification, which ends the validity of references
+    // returned by read(); new_data_ptr is unique or null
+    void commit(data_pointer new_data_ptr) noexcept {
+        if (new_data_ptr != nullptr)
+            new_data_ptr->read_called = false;
+        prefetched.reset();
+        data_ptr = std::move(new_data_ptr);
+    }
+
+public:
+
+    using key_type = K;
+    using value_type = V;
+    using allocator_type = typename Traits::allocator_type;
+
+    // key types other than K that read(), remove() and contains() take directly:
+    // those ordered against K for the ordered index and the persistent storage,
+    // those accepted by a transparent Hash and Equal for custom_hash_index
+    template <typename Q>
+    static constexpr bool is_lookup_key = !std::is_same_v<std::remove_cvref_t<Q>, K>
+        && binder_data::template accepts<Q>;
+
+private:
+
+    using alloc_traits = std::allocator_traits<allocator_type>;
+
+    [[no_unique_address]] allocator_type alloc;
+
+    // binder_data constructed from args in memory from alloc
+    template <typename... Args>
+    data_pointer make_data(Args&&... args) const {
+        return refcount::template make<binder_data>(alloc, std::forward<Args>(args)...);
+    }
+
+    // copy of old placed in memory from alloc
+    data_pointer clone(binder_data const& old, clone_reason reason) const {
+        if constexpr (tracer::enabled) {
+            auto start = std::chrono::steady_clock::now();
+            auto res = copy_data(old, reason);
+            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+            tracer::on_clone(clone_event{reason, res->size(), duration});
+            return res;
+        }
+        else {
+            return copy_data(old, reason);
+        }
+    }
+
+    data_pointer copy_data(binder_data const& old, clone_reason reason) const {
+        auto res = make_data(old, alloc);
+        auto& counter = (reason == clone_reason::copy)
+            ? global_clone_counters.on_copy
+            : global_clone_counters.on_write;
+        counter.fetch_add(1, std::memory_order_relaxed);
+        if (auto hook = clone_hook.load(std::memory_order_acquire))
+            hook(reason, res->size());
+        return res;
+    }
+
+    // returns the appropriate temporary pointer based on passed condition; a clone
+    // prepared by prefetch_unshare() is used if there is one, even for data no longer
+    // shared, which it reads until it's done. Data whose other owners have let go of it
+    // since cond was computed, even while it was being cloned, is taken over instead of cloned
+    decltype(auto) get_new_unique_shared(data_pointer const& old_ptr, bool cond) {
+        data_pointer ret_val;
+        if (old_ptr == nullptr)
+            ret_val = make_data(alloc);
+        else if (ret_val = take_prefetched(old_ptr); ret_val != nullptr)
+            return ret_val;
+        else if (cond || held_alone(old_ptr))
+            ret_val = old_ptr;
+        else {
+            try {
+                ret_val = clone(*old_ptr, clone_reason::write);
+            }
+            catch (...) {
+                if (!held_alone(old_ptr))
+                    throw;
+                ret_val = old_ptr;
+            }
+        }
+        return ret_val;
+    }
+
+    data_pointer take_prefetched(data_pointer const& old_ptr) {
+        if constexpr (clone_executor::enabled)
+            return prefetched.take(old_ptr);
+        else
+            return nullptr;
+    }
+
+    template <typename Q>
+    V take_impl(Q const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        if (!held_alone(data_ptr) && !data_ptr->contains(k))
+            throw std::invalid_argument("note doesn't exist in binder");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        V res = new_data_ptr->take(k);
+        if (!new_data_ptr->size())
+            new_data_ptr = nullptr;
+        commit(std::move(new_data_ptr));
+        return res;
+    }
+
+    // a shared binder is only cloned once k is known to be present
+    template <typename Q>
+    V* read_if_impl(Q const& k) {
+        if (data_ptr == nullptr)
+            return nullptr;
+        if (!held_alone(data_ptr) && !data_ptr->contains(k))
+            return nullptr;
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        V* res = new_data_ptr->read_if(k);
+        if (res == nullptr)
+            return nullptr;
+        data_ptr = std::move(new_data_ptr);
+        data_ptr->read_called = true;
+        prefetched.reset();
+        return res;
+    }
+
+    // prev_k is nullptr for the front
+    void splice_impl(K const* prev_k, binder&& other) {
+        if (prev_k != nullptr && !data_ptr->contains(*prev_k))
+            throw std::invalid_argument("binder doesn't contain previous entry");
+        if (other.data_ptr == nullptr)
+            return;
+        other.prefetched.reset();
+        bool movable = held_alone(other.data_ptr);
+        if (data_ptr == nullptr && movable && alloc == other.alloc) {
+            commit(std::move(other.data_ptr));
+            other.data_ptr = nullptr;
+            return;
+        }
+        if (data_ptr != nullptr)
+            for (auto it = other.cbegin(); it != other.cend(); ++it)
+                if (data_ptr->contains(it.key()))
+                    throw std::invalid_argument("binder already contains entry with given key");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->splice(prev_k, *other.data_ptr, movable);
+        commit(std::move(new_data_ptr));
+        other.data_ptr = nullptr;
+    }
+
+    static void throw_if_rejected(insert_status status) {
+        if (status == insert_status::key_exists)
+            throw std::invalid_argument("binder already contains entry with given key");
+        if (status == insert_status::previous_missing)
+            throw std::invalid_argument("binder doesn't contain previous entry");
+    }
+
+    // a shared binder is only cloned once the insertion is known to succeed
+    template <typename KK, typename... Args>
+    insert_status try_emplace_front_impl(KK&& k, Args&&... args) {
+        bool unique = held_alone(data_ptr);
+        if (!unique && data_ptr != nullptr && data_ptr->contains(k))
+            return insert_status::key_exists;
+        auto new_data_ptr = get_new_unique_shared(data_ptr, unique);
+        auto status = new_data_ptr->try_emplace_front(std::forward<KK>(k), std::forward<Args>(args)...);
+        if (status != insert_status::inserted)
+            return status;
+        commit(std::move(new_data_ptr));
+        return status;
+    }
+
+    template <typename KK, typename... Args>
+    insert_status try_emplace_after_impl(K const& prev_k, KK&& k, Args&&... args) {
+        if (data_ptr == nullptr)
+            return insert_status::previous_missing;
+        bool unique = held_alone(data_ptr);
+        if (!unique && data_ptr->contains(k))
+            return insert_status::key_exists;
+        if (!unique && !data_ptr->contains(prev_k))
+            return insert_status::previous_missing;
+        auto new_data_ptr = get_new_unique_shared(data_ptr, unique);
+        auto status = new_data_ptr->try_emplace_after(prev_k, std::forward<KK>(k), std::forward<Args>(args)...);
+        if (status != insert_status::inserted)
+            return status;
+        commit(std::move(new_data_ptr));
+        return status;
+    }
+
+public:
+
+    binder() noexcept : data_ptr{}, alloc{} {}
+
+    explicit binder(allocator_type const& a) noexcept : data_ptr{}, alloc{a} {}
+
+    ~binder() noexcept {
+        data_ptr = nullptr;
+    }
+
+    // notes made from the elements of il in that order, the first element becomes the front
+    binder(std::initializer_list<std::pair<K, V>> il, allocator_type const& a = allocator_type())
+        : data_ptr{}, alloc{a} {
+        if (il.size() != 0)
+            data_ptr = make_data(il.begin(), il.end(), alloc);
+    }
+
+    // notes made from the pair-like elements of rg in that order, moved from if rg is an rvalue
+    template <detail::note_range<K, V> R>
+    binder(from_range_t, R&& rg, allocator_type const& a = allocator_type())
+        : data_ptr{}, alloc{a} {
+        auto first = [&rg] {
+            if constexpr (std::is_lvalue_reference_v<R>)
+                return std::ranges::begin(rg);
+            else
+                return std::make_move_iterator(std::ranges::begin(rg));
+        }();
+        auto last = [&rg] {
+            if constexpr (std::is_lvalue_reference_v<R>)
+                return std::ranges::end(rg);
+            else
+                return std::move_sentinel(std::ranges::end(rg));
+        }();
+        if (first == last)
+            return;
+        data_ptr = make_data(std::move(first), std::move(last), alloc);
+    }
+
+    // performs deep copy if the copied-from object previously called non-const read()
+    // or holds a live write handle, to ensure proper COW
+    binder(binder const& rhs)
+        : data_ptr{}, alloc{alloc_traits::select_on_container_copy_construction(rhs.alloc)} {
+        data_ptr = rhs.unshareable()
+            ? clone(*rhs.data_ptr, clone_reason::copy)
+            : rhs.data_ptr;
+    }
+
+    // same as the copy constructor, but later clones are allocated from a
+    binder(binder const& rhs, allocator_type const& a) : data_ptr{}, alloc{a} {
+        data_ptr = rhs.unshareable()
+            ? clone(*rhs.data_ptr, clone_reason::copy)
+            : rhs.data_ptr;
+    }
+
+    binder(binder&& rhs) noexcept
+        : data_ptr{std::move(rhs.data_ptr)}, prefetched{std::move(rhs.prefetched)}, alloc{rhs.alloc} {
+        rhs.data_ptr = nullptr;
+    }
+
+    // shared data stays in the memory it was allocated in, only
+    // copies made from now on use the propagated allocator
+    binder& operator=(binder const& rhs) {
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;
+        prefetched.reset();
+        data_ptr = (rhs.data_ptr == nullptr || !rhs.unshareable())
+            ? rhs.data_ptr
+            : clone(*rhs.data_ptr, clone_reason::copy);
+        return *this;
+    }
+
+    binder& operator=(binder&& rhs) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            alloc = rhs.alloc;
+        prefetched = std::move(rhs.prefetched);
+        data_ptr = std::move(rhs.data_ptr);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return alloc;
+    }
+
+    void insert_front(K const& k, V const& v) {
+        emplace_front(k, v);
+    }
+
+    void insert_front(K&& k, V&& v) {
+        emplace_front(std::move(k), std::move(v));
+    }
+
+    // constructs the value of the new note in place from args; neither k nor args
+    // are moved from if the note can't be inserted
+    template <typename... Args>
+    void emplace_front(K const& k, Args&&... args) {
+        throw_if_rejected(try_emplace_front_impl(k, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    void emplace_front(K&& k, Args&&... args) {
+        throw_if_rejected(try_emplace_front_impl(std::move(k), std::forward<Args>(args)...));
+    }
+
+    // same as insert_front, but reports a duplicate key instead of throwing
+    insert_status try_insert_front(K const& k, V const& v) {
+        return try_emplace_front_impl(k, v);
+    }
+
+    insert_status try_insert_front(K&& k, V&& v) {
+        return try_emplace_front_impl(std::move(k), std::move(v));
+    }
+
+    void insert_after(K const& prev_k, K const& k, V const& v) {
+        emplace_after(prev_k, k, v);
+    }
+
+    void insert_after(K const& prev_k, K&& k, V&& v) {
+        emplace_after(prev_k, std::move(k), std::move(v));
+    }
+
+    template <typename... Args>
+    void emplace_after(K const& prev_k, K const& k, Args&&... args) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        throw_if_rejected(try_emplace_after_impl(prev_k, k, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    void emplace_after(K const& prev_k, K&& k, Args&&... args) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        throw_if_rejected(try_emplace_after_impl(prev_k, std::move(k), std::forward<Args>(args)...));
+    }
+
+    // same as insert_after, but reports a duplicate key or a missing previous
+    // note instead of throwing
+    insert_status try_insert_after(K const& prev_k, K const& k, V const& v) {
+        return try_emplace_after_impl(prev_k, k, v);
+    }
+
+    insert_status try_insert_after(K const& prev_k, K&& k, V&& v) {
+        return try_emplace_after_impl(prev_k, std::move(k), std::move(v));
+    }
+
+    void remove() {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->remove();
+        if (!new_data_ptr->size())
+            new_data_ptr = nullptr;
+        commit(std::move(new_data_ptr));
+    }
+
+    void remove(K const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        if (!held_alone(data_ptr) && !data_ptr->contains(k))
+            throw std::invalid_argument("note doesn't exist in binder");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->remove(k);
+        if (!new_data_ptr->size())
+            new_data_ptr = nullptr;
+        commit(std::move(new_data_ptr));
+    }
+
+    // removes the note with key equal to k without constructing a K, for key types
+    // accepted by the index (see is_lookup_key)
+    template <typename Q> requires is_lookup_key<Q>
+    void remove(Q const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        if (!held_alone(data_ptr) && !data_ptr->contains(k))
+            throw std::invalid_argument("note doesn't exist in binder");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->remove(k);
+        if (!new_data_ptr->size())
+            new_data_ptr = nullptr;
+        commit(std::move(new_data_ptr));
+    }
+
+    // removes the note with key k and returns its value, moved out of the note if that
+    // can't throw; shared data is cloned first, as by remove(k)
+    V take(K const& k) {
+        return take_impl(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    V take(Q const& k) {
+        return take_impl(k);
+    }
+
+    // moving notes between binders: when other isn't shared and uses an equal allocator,
+    // list storage relinks its nodes and index entries without touching the notes, and
+    // slab storage moves notes whose keys and values don't throw on move; otherwise the
+    // notes are copied. Both binders are left unchanged if an exception is thrown
+
+    // moves the notes of other after the note with key prev_k, keeping their order, and
+    // empties other; throws if prev_k is missing or a key of other is present
+    void splice_after(K const& prev_k, binder&& other) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        splice_impl(&prev_k, std::move(other));
+    }
+
+    // moves the notes of other to the front
+    void splice_front(binder&& other) {
+        splice_impl(nullptr, std::move(other));
+    }
+
+    // moves the notes of other after the last note
+    void merge(binder&& other) {
+        if (data_ptr == nullptr)
+            splice_impl(nullptr, std::move(other));
+        else
+            splice_impl(&std::prev(cend()).key(), std::move(other));
+    }
+
+    // moves the notes following the note with key k into the returned binder,
+    // which uses the same allocator
+    binder split_after(K const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        if (!data_ptr->contains(k))
+            throw std::invalid_argument("note doesn't exist in binder");
+
+        auto rest = make_data(alloc);
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->split_after(k, *rest);
+        commit(std::move(new_data_ptr));
+        binder res(alloc);
+        if (rest->size())
+            res.data_ptr = std::move(rest);
+        return res;
+    }
+
+    // batch operations check for sharing and clone a shared binder at most once,
+    // and give the strong exception guarantee
+
+    // inserts the pair-like elements of [first, last) at the front, keeping their order;
+    // throws if any of their keys is already present or repeated
+    template <std::input_iterator It, std::sentinel_for<It> S>
+    void insert_front_range(It first, S last) {
+        if (first == last)
+            return;
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->insert_range_front(std::move(first), std::move(last));
+        commit(std::move(new_data_ptr));
+    }
+
+    // inserts the pair-like elements of [first, last) after the note with key prev_k,
+    // keeping their order
+    template <std::input_iterator It, std::sentinel_for<It> S>
+    void insert_after_range(K const& prev_k, It first, S last) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        if (!held_alone(data_ptr) && !data_ptr->contains(prev_k))
+            throw std::invalid_argument("binder doesn't contain previous entry");
+        if (first == last)
+            return;
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->insert_range_after(prev_k, std::move(first), std::move(last));
+        commit(std::move(new_data_ptr));
+    }
+
+    // removes the notes with the given keys, throws without removing anything
+    // if any of them doesn't exist; repeated keys are removed once
+    template <std::ranges::forward_range R>
+    void remove_keys(R const& keys) {
+        if (std::ranges::empty(keys))
+            return;
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        for (auto const& k : keys)
+            if (!data_ptr->contains(k))
+                throw std::invalid_argument("note doesn't exist in binder");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        new_data_ptr->remove_keys(keys);
+        if (!new_data_ptr->size())
+            new_data_ptr = nullptr;
+        commit(std::move(new_data_ptr));
+    }
+
+    V& read(K const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        V& res = new_data_ptr->read(k);
+        data_ptr = new_data_ptr;
+        data_ptr->read_called = true;
+        prefetched.reset();
+        return res;
+    }
+
+    V const& read(K const& k) const {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        return data_ptr->read_const(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    V& read(Q const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        V& res = new_data_ptr->read(k);
+        data_ptr = new_data_ptr;
+        data_ptr->read_called = true;
+        prefetched.reset();
+        return res;
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    V const& read(Q const& k) const {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        return data_ptr->read_const(k);
+    }
+
+    bool contains(K const& k) const {
+        return data_ptr != nullptr && data_ptr->contains(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    bool contains(Q const& k) const {
+        return data_ptr != nullptr && data_ptr->contains(k);
+    }
+
+    // pointer to the value of the note with key k, nullptr if there is none;
+    // unlike read(), a miss clones nothing and doesn't make the binder unshareable
+    V* read_if(K const& k) {
+        return read_if_impl(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    V* read_if(Q const& k) {
+        return read_if_impl(k);
+    }
+
+    V const* read_if(K const& k) const {
+        return (data_ptr == nullptr) ? nullptr : data_ptr->read_const_if(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    V const* read_if(Q const& k) const {
+        return (data_ptr == nullptr) ? nullptr : data_ptr->read_const_if(k);
+    }
+
+    class write_handle;
+
+    // scoped mutable access to the note with key k: copies of the binder are deep only
+    // while the returned handle lives, unlike after non-const read()
+    [[nodiscard]] write_handle write(K const& k) {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+
+        auto new_data_ptr = get_new_unique_shared(data_ptr, held_alone(data_ptr));
+        V& res = new_data_ptr->read(k);
+        data_ptr = new_data_ptr;
+        prefetched.reset();
+        return write_handle(std::move(new_data_ptr), res);
+    }
+
+    // calls fn with a mutable reference to the note with key k and returns its result,
+    // by value, since a reference would outlive the write handle
+    template <typename F>
+    std::remove_cvref_t<std::invoke_result_t<F, V&>> modify(K const& k, F&& fn) {
+        auto handle = write(k);
+        return std::invoke(std::forward<F>(fn), *handle);
+    }
+
+    std::size_t size() const noexcept {
+        return (data_ptr == nullptr) ? 0 : data_ptr->size();
+    }
+
+
+    void clear() noexcept {
+        prefetched.reset();
+        data_ptr = nullptr;
+    }
+
+    // starts a deep copy of shared data on Traits::clone_executor; the next modification
+    // takes it over instead of copying on its own thread, waiting for it to finish if
+    // needed, and copies by itself if it failed. The copy doesn't count as an owner of
+    // the data, so is_shared() is unaffected, but changing or dropping the data waits for
+    // it to finish. Does nothing for data that isn't shared
+    void prefetch_unshare() requires clone_executor::enabled && refcount::thread_safe {
+        if (data_ptr == nullptr || held_alone(data_ptr) || prefetched.prepared_from(data_ptr))
+            return;
+        prefetched.template start<clone_executor>(data_ptr, [copier = binder(alloc)](binder_data const& data) {
+            return copier.clone(data, clone_reason::write);
+        });
+    }
+
+    // the notes in order, leaving the binder empty; the data of a binder that is its only
+    // owner is consumed, with keys and values moved out if neither can throw on move,
+    // otherwise they are copied and the binder is left unchanged if that throws
+    std::vector<std::pair<K, V>> extract_all() && {
+        std::vector<std::pair<K, V>> res;
+        prefetched.reset();
+        if (data_ptr == nullptr)
+            return res;
+        if (held_alone(data_ptr)) {
+            res = data_ptr->extract_all();
+        }
+        else {
+            res.reserve(size());
+            for (auto it = cbegin(); it != cend(); ++it)
+                res.emplace_back(it.key(), *it);
+        }
+        clear();
+        return res;
+    }
+
+    // exchanges the data of the binders, never copying it; allocators are exchanged only
+    // if they propagate on swap, the data stays in the memory it was allocated in
+    void swap(binder& rhs) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value)
+            std::swap(alloc, rhs.alloc);
+        std::swap(data_ptr, rhs.data_ptr);
+        std::swap(prefetched, rhs.prefetched);
+    }
+
+    friend void swap(binder& lhs, binder& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // whether the data is shared with another binder, so that the next modification clones it
+    bool is_shared() const noexcept {
+        return data_ptr != nullptr && !held_alone(data_ptr);
+    }
+
+    // bytes held by the binder together with its data, shared or not;
+    // node sizes of std::list and std::map are estimated
+    std::size_t memory_footprint() const noexcept {
+        return stats().total_bytes;
+    }
+
+    binder_stats stats() const noexcept {
+        binder_stats res{};
+        res.total_bytes = sizeof(binder);
+        if (data_ptr == nullptr)
+            return res;
+        res.notes = data_ptr->size();
+        res.storage_bytes = data_ptr->storage_bytes();
+        res.index_bytes = data_ptr->index_bytes();
+        res.total_bytes += sizeof(binder_data) + res.storage_bytes + res.index_bytes;
+        res.bytes_per_note = static_cast<double>(res.total_bytes) / static_cast<double>(res.notes);
+        res.use_count = data_ptr.use_count() - static_cast<long>(data_ptr->writers);
+        res.deep_copies = data_ptr->deep_copies;
+        return res;
+    }
+
+    class const_iterator;
+
+    const_iterator cbegin() const noexcept {
+        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->cbegin(), data_ptr.get());
+    }
+
+    const_iterator cend() const noexcept {
+        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->cend(), data_ptr.get());
+    }
+
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // notes from the last one; the key of r is std::prev(r.base()).key()
+    const_reverse_iterator crbegin() const noexcept {
+        return const_reverse_iterator(cend());
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return const_reverse_iterator(cbegin());
+    }
+
+    // make a binder a bidirectional range of its values, which is read-only
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    // iterator at the note with key k, cend() if there is none
+    const_iterator find(K const& k) const {
+        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->find(k), data_ptr.get());
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    const_iterator find(Q const& k) const {
+        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->find(k), data_ptr.get());
+    }
+
+    // positional queries in binder order; O(log n) with ranked_storage, O(n) otherwise
+
+    // iterator at the i-th note counting from 0, cend() if i >= size()
+    const_iterator at_position(std::size_t i) const {
+        if (i >= size())
+            return cend();
+        return const_iterator(data_ptr->at_position(i), data_ptr.get());
+    }
+
+    // number of notes before the note with key k
+    std::size_t position_of(K const& k) const {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        return data_ptr->position_of(k);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    std::size_t position_of(Q const& k) const {
+        if (data_ptr == nullptr)
+            throw std::invalid_argument("binder is empty");
+        return data_ptr->position_of(k);
+    }
+
+    // view of the (key, value) pairs of the notes with keys in [lo, hi), in key order,
+    // valid until the binder is modified; for ordered_index only, O(log n) to create
+    auto key_range(K const& lo, K const& hi) const
+        requires requires { binder_data::key_range(data_ptr.get(), lo, hi); } {
+        return binder_data::key_range(data_ptr.get(), lo, hi);
+    }
+
+    template <typename Q> requires is_lookup_key<Q>
+    auto key_range(Q const& lo, Q const& hi) const
+        requires requires { binder_data::key_range(data_ptr.get(), lo, hi); } {
+        return binder_data::key_range(data_ptr.get(), lo, hi);
+    }
+
+    // splits the notes into at most parts consecutive subranges of nearly equal length,
+    // which can be traversed independently; O(n)
+    std::vector<std::ranges::subrange<const_iterator>> partition(std::size_t parts) const {
+        std::vector<std::ranges::subrange<const_iterator>> res;
+        std::size_t n = size();
+        parts = std::min(std::max<std::size_t>(parts, 1), n);
+        res.reserve(parts);
+        auto it = cbegin();
+        for (std::size_t i = 0; i < parts; ++i) {
+            auto first = it;
+            std::ranges::advance(it, static_cast<std::ptrdiff_t>(n / parts + (i < n % parts)));
+            res.emplace_back(first, it);
+        }
+        return res;
+    }
+
+    // calls fn on every value from up to threads threads; the order of the calls is
+    // unspecified and fn must be safe to call concurrently; slab storage is split by
+    // slots, other storages are partitioned by a single walk first
+    template <typename F>
+    void for_each_parallel(F fn, unsigned threads = std::thread::hardware_concurrency()) const {
+        std::size_t n = size();
+        if (n == 0)
+            return;
+        std::size_t parts = std::min<std::size_t>(std::max(threads, 1u), (n + parallel_grain - 1) / parallel_grain);
+        if constexpr (requires { data_ptr->slot_count(); }) {
+            std::size_t slots = data_ptr->slot_count();
+            detail::run_parallel(parts, [&](std::size_t i) {
+                data_ptr->visit_slots(slots * i / parts, slots * (i + 1) / parts, fn);
+            });
+        }
+        else {
+            auto ranges = partition(parts);
+            detail::run_parallel(ranges.size(), [&](std::size_t i) {
+                for (V const& v : ranges[i])
+                    fn(v);
+            });
+        }
+    }
+}; // class binder
+
+template <typename K, typename V, typename Traits>
+class binder<K, V, Traits>::linked_data : public share_state {
+
+    static constexpr bool shared_values = Traits::values::shared;
+    using stored_value = std::conditional_t<shared_values, detail::shared_value<V>, V>;
+    using storage_type = typename Traits::storage::template type<std::pair<K, stored_value>, allocator_type>;
+
+    storage_type content;
+    using handle_t = typename storage_type::handle;
+    using index_type = typename Traits::index::template type<K, handle_t, allocator_type>;
+    index_type address;
+
+    // for shared values: the current generation, which changes whenever the mutable
+    // references handed out before can't be in use anymore, and the keys of the values
+    // handed out in it, which a copy must not share while references may be in use
+    std::uint64_t generation;
+    std::vector<K, detail::rebind_alloc_t<allocator_type, K>> exposed;
+
+    static V const& value(stored_value const& v) noexcept {
+        if constexpr (shared_values)
+            return *v.ptr;
+        else
+            return v;
+    }
+
+    static V& value(stored_value& v) noexcept {
+        if constexpr (shared_values)
+            return *v.ptr;
+        else
+            return v;
+    }
+
+    // arguments constructing the stored value of a new note from args
+    template <typename... Args>
+        requires std::constructible_from<V, Args...>
+    auto value_args(Args&&... args) const {
+        if constexpr (shared_values)
+            return std::tuple<stored_value>(stored_value{
+                std::allocate_shared<V>(address.get_allocator(), std::forward<Args>(args)...), 0});
+        else
+            return std::forward_as_tuple(std::forward<Args>(args)...);
+    }
+
+    // the value of a note copied from other data is shared with it
+    auto value_args(stored_value const& v) const {
+        if constexpr (shared_values)
+            return std::tuple<stored_value>(stored_value{v.ptr, 0});
+        else
+            return std::forward_as_tuple(v);
+    }
 
-    // data_ptr == nullptr indicates empty binder
-    std::shared_ptr<binder_data> data_ptr;
+    // makes the value of v private to this data
+    void own(stored_value& v) {
+        if constexpr (shared_values)
+            if (v.ptr.use_count() != 1)
+                v.ptr = std::allocate_shared<V>(address.get_allocator(), std::as_const(*v.ptr));
+    }
+
+    // the value of the note with key k, private to this data, for a mutable reference
+    V& expose(K const& k, stored_value& v) {
+        if constexpr (shared_values) {
+            own(v);
+            if (!this->read_called && !this->pinned()) {
+                exposed.clear();
+                generation = detail::next_generation();
+            }
+            if (v.exposed_in != generation) {
+                exposed.push_back(k);
+                v.exposed_in = generation;
+            }
+            return *v.ptr;
+        }
+        else {
+            return v;
+        }
+    }
 
-    // indicator of whether there exists a non-const reference to the object's data
-    bool read_called;
+    // the value of v for a note that is about to be erased, moved out if no other data
+    // shares it and its move can't throw
+    static V release_value(stored_value& v) {
+        if constexpr (shared_values) {
+            if (v.ptr.use_count() != 1)
+                return *v.ptr;
+            return V(std::move_if_noexcept(*v.ptr));
+        }
+        else {
+            return V(std::move_if_noexcept(v));
+        }
+    }
 
-    // returns the appropriate temporary pointer based on passed condition
-    decltype(auto) get_new_unique_shared(std::shared_ptr<binder_data> const& old_ptr, bool cond) {
-        std::shared_ptr<binder_data> ret_val;
-        if (old_ptr == nullptr)
-            ret_val = std::make_shared<binder_data>();
-        else if (cond)
-            ret_val = old_ptr;
-        else
-            ret_val = std::make_shared<binder_data>(*old_ptr);
-        return ret_val;
+    // removes n consecutive notes starting at h
+    void erase_block(handle_t h, std::size_t n) {
+        while (n--) {
+            auto next = content.next(h);
+            address.erase(content.get(h).first);
+            content.erase(h);
+            h = next;
+        }
+    }
+
+    // undoes the insertion of the n consecutive notes starting at h, the newest ones
+    // in the index, without allocating: a lazy index that wasn't built drops its newest
+    // entries, which erasing one by one could only do by building it
+    void erase_inserted_block(handle_t h, std::size_t n) {
+        if constexpr (requires { address.drop_newest(n); }) {
+            if (address.drop_newest(n)) {
+                while (n--) {
+                    auto next = content.next(h);
+                    content.erase(h);
+                    h = next;
+                }
+                return;
+            }
+        }
+        erase_block(h, n);
+    }
+
+    // inserts the pair-like elements of [first, last) as consecutive notes after
+    // *prev, or at the front if prev is nullptr; either all of them are inserted or none
+    template <typename It, typename S>
+    void insert_block(handle_t const* prev, It first, S last) {
+        if constexpr (std::forward_iterator<It>) {
+            auto n = static_cast<std::size_t>(std::ranges::distance(first, last));
+            content.reserve(content.size() + n);
+            address.reserve(address.size() + n);
+        }
+        std::size_t inserted = 0;
+        handle_t block_first{};
+        handle_t tail = (prev == nullptr) ? handle_t{} : *prev;
+        try {
+            for (; first != last; ++first) {
+                auto&& e = *first;
+                auto pos = address.locate(std::get<0>(e));
+                if (pos.found)
+                    throw std::invalid_argument("binder already contains entry with given key");
+                auto key_arg = std::forward_as_tuple(std::get<0>(std::forward<decltype(e)>(e)));
+                auto value_arg = value_args(std::get<1>(std::forward<decltype(e)>(e)));
+                auto h = (inserted == 0 && prev == nullptr)
+                    ? content.emplace_front(std::piecewise_construct, std::move(key_arg), std::move(value_arg))
+                    : content.emplace_after(tail, std::piecewise_construct, std::move(key_arg), std::move(value_arg));
+                try {
+                    address.insert_at(pos, &content.get(h).first, h);
+                }
+                catch (...) {
+                    content.erase(h);
+                    throw;
+                }
+                if (inserted++ == 0)
+                    block_first = h;
+                tail = h;
+            }
+        }
+        catch (...) {
+            erase_inserted_block(block_first, inserted);
+            throw;
+        }
+    }
+
+    // whether the notes and index entries of other live in memory this data can take over
+    bool same_allocator(linked_data const& other) const noexcept {
+        return address.get_allocator() == other.address.get_allocator();
+    }
+
+    // inserts m notes of src starting at first after *prev, or at the front if prev is
+    // nullptr; if movable they are moved out of src where nothing can throw half-way,
+    // otherwise copied and src is left unchanged. Returns whether they were moved; an
+    // exception leaves both unchanged
+    bool take_notes(linked_data& src, handle_t first, std::size_t m, handle_t const* prev, bool movable) {
+        constexpr bool nothrow_moves = detail::slot_storage<storage_type>
+            && std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<stored_value>;
+        if constexpr (nothrow_moves) {
+            if (movable && same_allocator(src)) {
+                // slab storage and the index take every note without allocating from now on
+                content.reserve(content.size() + m);
+                address.reserve(address.size() + m);
+                handle_t tail = (prev == nullptr) ? handle_t{} : *prev;
+                for (std::size_t i = 0; i < m; ++i) {
+                    handle_t next = src.content.next(first);
+                    auto& note = src.content.get(first);
+                    auto pos = src.address.locate(note.first);
+                    tail = (i == 0 && prev == nullptr)
+                        ? content.emplace_front(std::move(note))
+                        : content.emplace_after(tail, std::move(note));
+                    src.address.move_entry_at(pos, &content.get(tail).first, tail, address);
+                    src.content.erase(first);
+                    first = next;
+                }
+                return true;
+            }
+        }
+        auto it = src.content.iterator_at(first);
+        insert_block(prev, it, std::next(it, static_cast<std::ptrdiff_t>(m)));
+        return false;
+    }
+
+    // builds the index of copy, a fresh copy of source indexed by original; when the copy
+    // keeps the handles, original is copied as is, an ordered map is copied in order with
+    // its handles translated, otherwise the index is bulk-loaded
+    static index_type clone_index(storage_type& copy, storage_type const& source, index_type const& original,
+        allocator_type const& a) {
+        if constexpr (storage_type::copies_keep_handles) {
+            return index_type(original, a, [&copy](handle_t h) {
+                return &copy.get(h).first;
+            });
+        }
+        else if constexpr (std::is_same_v<index_type, detail::ordered_map_index<K, handle_t, allocator_type>>) {
+            detail::handle_map<handle_t, allocator_type> handles(source, copy, a);
+            return index_type(original, a, [&](handle_t h) {
+                handle_t c = handles[&source.get(h)];
+                return std::pair{&copy.get(c).first, c};
+            });
+        }
+        else {
+            std::vector<std::pair<K const*, handle_t>, detail::rebind_alloc_t<allocator_type,
+                std::pair<K const*, handle_t>>> entries(a);
+            entries.reserve(copy.size());
+            for (auto h = copy.head(); h != copy.end_handle(); h = copy.next(h))
+                entries.emplace_back(&copy.get(h).first, h);
+            index_type res(a);
+            res.bulk_insert(entries);
+            return res;
+        }
     }
 
 public:
 
-    binder() noexcept : data_ptr{}, read_called{} {}
+    using const_iterator = typename storage_type::const_iterator;
 
-    ~binder() noexcept {
-        data_ptr = nullptr;
+    static K const& key_of(const_iterator const& it) noexcept {
+        return it->first;
     }
 
-    // performs deep copy if the copied-from object previously called non-const read()
-    // to ensure proper COW
-    binder(binder const& rhs) : data_ptr{}, read_called{} {
-        data_ptr = rhs.read_called
-            ? std::make_shared<binder_data>(*rhs.data_ptr)
-            : rhs.data_ptr;
+    static V const& value_of(const_iterator const& it) noexcept {
+        return value(it->second);
     }
 
-    binder(binder&& rhs) noexcept : data_ptr{std::move(rhs.data_ptr)}, read_called{std::move(rhs.read_called)} {
-        rhs.data_ptr = nullptr;
+    explicit linked_data(allocator_type const& a)
+        : content{a}, address{a}, generation{detail::next_generation()}, exposed(a) {}
+
+    // shared values are copied only where rhs may have handed out a reference still in use
+    linked_data(linked_data const& rhs, allocator_type const& a)
+        : share_state{rhs}, content{rhs.content, a}, address{clone_index(content, rhs.content, rhs.address, a)},
+          generation{detail::next_generation()}, exposed(a) {
+        if constexpr (shared_values) {
+            if (!rhs.read_called && !rhs.pinned())
+                return;
+            for (auto const& k : rhs.exposed)
+                if (auto h = address.find(k))
+                    own(content.get(*h).second);
+        }
     }
 
-    binder& operator=(binder const& rhs) {
-        data_ptr = (rhs.data_ptr == nullptr || !rhs.read_called)
-            ? rhs.data_ptr
-            : std::make_shared<binder_data>(*rhs.data_ptr);
-            
-        read_called = false;
-        return *this;
+    // the index keeps pointing at the keys, so storages that move them can't be moved
+    linked_data(linked_data&& rhs) noexcept(std::is_nothrow_move_constructible_v<storage_type>
+        && std::is_nothrow_move_constructible_v<index_type>) requires storage_type::moves_keep_keys
+        : content{std::move(rhs.content)}, address{std::move(rhs.address)}, generation{rhs.generation},
+          exposed{std::move(rhs.exposed)} {}
+
+    // notes made from the pair-like elements of [first, last) in that order; the content
+    // is appended in one pass and the index is bulk-loaded afterwards
+    template <typename It, typename S>
+    linked_data(It first, S last, allocator_type const& a)
+        : content{a}, address{a}, generation{detail::next_generation()}, exposed(a) {
+        using entry = std::pair<K const*, handle_t>;
+        std::vector<entry, detail::rebind_alloc_t<allocator_type, entry>> entries(a);
+        if constexpr (std::forward_iterator<It>) {
+            auto n = static_cast<std::size_t>(std::ranges::distance(first, last));
+            content.reserve(n);
+            entries.reserve(n);
+        }
+        handle_t tail{};
+        for (; first != last; ++first) {
+            auto&& e = *first;
+            auto key_arg = std::forward_as_tuple(std::get<0>(std::forward<decltype(e)>(e)));
+            auto value_arg = value_args(std::get<1>(std::forward<decltype(e)>(e)));
+            tail = entries.empty()
+                ? content.emplace_front(std::piecewise_construct, std::move(key_arg), std::move(value_arg))
+                : content.emplace_after(tail, std::piecewise_construct, std::move(key_arg), std::move(value_arg));
+            entries.emplace_back(&content.get(tail).first, tail);
+        }
+        if (!address.bulk_insert_unique(entries))
+            throw std::invalid_argument("binder already contains entry with given key");
     }
 
-    binder& operator=(binder&& rhs) noexcept {
-        data_ptr = std::move(rhs.data_ptr);
-        read_called = std::move(rhs.read_called);
-        return *this;
+    // k and args are only consumed once the note is known to be insertable
+    template <typename KK, typename... Args>
+    insert_status try_emplace_front(KK&& k, Args&&... args) {
+        auto pos = address.locate(k);
+        if (pos.found)
+            return insert_status::key_exists;
+        auto new_handle = content.emplace_front(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<KK>(k)), value_args(std::forward<Args>(args)...));
+        try {
+            address.insert_at(pos, &content.get(new_handle).first, new_handle);
+        }
+        catch (...) {
+            content.erase(new_handle);
+            throw;
+        }
+        return insert_status::inserted;
     }
 
-    void insert_front(K const& k, V const& v) {
-        auto new_data_ptr = get_new_unique_shared(data_ptr, data_ptr.use_count() == 1);
-        new_data_ptr->insert_front(k, v);
-        read_called = false;
-        data_ptr = new_data_ptr;
+    template <typename KK, typename... Args>
+    insert_status try_emplace_after(K const& prev_k, KK&& k, Args&&... args) {
+        auto pos = address.locate(k);
+        if (pos.found)
+            return insert_status::key_exists;
+        auto prev = address.find(prev_k);
+        if (prev == nullptr)
+            return insert_status::previous_missing;
+        auto new_handle = content.emplace_after(*prev, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<KK>(k)), value_args(std::forward<Args>(args)...));
+        try {
+            address.insert_at(pos, &content.get(new_handle).first, new_handle);
+        }
+        catch (...) {
+            content.erase(new_handle);
+            throw;
+        }
+        return insert_status::inserted;
     }
 
-    void insert_after(K const& prev_k, K const& k, V const& v) {
-        if (data_ptr == nullptr)
-            throw std::invalid_argument("binder is empty");
-        auto new_data_ptr = get_new_unique_shared(data_ptr, data_ptr.use_count() == 1);
-        new_data_ptr->insert_after(prev_k, k, v);
-        read_called = false;
-        data_ptr = new_data_ptr;
+    template <typename Q>
+    static constexpr bool accepts = index_type::template accepts<Q>;
+
+    template <typename Q>
+    bool contains(Q const& k) const {
+        return address.contains(k);
     }
 
-    void remove() {
-        if (data_ptr == nullptr)
-            throw std::invalid_argument("binder is empty");
+    template <typename It, typename S>
+    void insert_range_front(It first, S last) {
+        insert_block(nullptr, std::move(first), std::move(last));
+    }
 
-        auto new_data_ptr = get_new_unique_shared(data_ptr, data_ptr.use_count() == 1);
-        new_data_ptr->remove();
-        if (!new_data_ptr->size())
-            new_data_ptr = nullptr;
-        read_called = false;
-        data_ptr = new_data_ptr;
+    template <typename It, typename S>
+    void insert_range_after(K const& prev_k, It first, S last) {
+        auto prev = address.find(prev_k);
+        if (prev == nullptr)
+            throw std::invalid_argument("binder doesn't contain previous entry");
+        handle_t prev_handle = *prev;
+        insert_block(&prev_handle, std::move(first), std::move(last));
     }
 
-    void remove(K const& k) {
-        if (data_ptr == nullptr)
-            throw std::invalid_argument("binder is empty");
+    // moves the notes of other after the note with key *prev_k, or to the front if prev_k
+    // is nullptr; none of their keys may be present. With movable, other may be emptied,
+    // otherwise it is left unchanged and its notes are copied; either way other is to be
+    // discarded afterwards
+    void splice(K const* prev_k, linked_data& other, bool movable) {
+        handle_t prev_handle{};
+        if (prev_k != nullptr)
+            prev_handle = *address.find(*prev_k);
+        handle_t const* prev = (prev_k == nullptr) ? nullptr : &prev_handle;
+        std::size_t m = other.content.size();
+        if constexpr (detail::splicing_storage<storage_type>) {
+            if (movable && same_allocator(other)) {
+                // the nodes are relinked as they are, only the index entries move; locating
+                // a present key builds a lazy index first, so nothing throws past the relink
+                address.reserve(address.size() + m);
+                if (m != 0)
+                    other.address.locate(other.content.get(other.content.head()).first);
+                content.splice_after(prev, other.content);
+                handle_t h = (prev == nullptr) ? content.head() : content.next(*prev);
+                for (std::size_t i = 0; i < m; ++i, h = content.next(h)) {
+                    K const& k = content.get(h).first;
+                    other.address.move_entry_at(other.address.locate(k), &k, h, address);
+                }
+                return;
+            }
+        }
+        take_notes(other, other.content.head(), m, prev, movable);
+    }
 
-        auto new_data_ptr = get_new_unique_shared(data_ptr, data_ptr.use_count() == 1);
-        new_data_ptr->remove(k);
-        if (!new_data_ptr->size())
-            new_data_ptr = nullptr;
-        read_called = false;
-        data_ptr = new_data_ptr;
+    // moves the notes following the note with key k into other, which must be empty
+    void split_after(K const& k, linked_data& other) {
+        handle_t h = *address.find(k);
+        std::size_t m = 0;
+        for (auto i = content.next(h); i != content.end_handle(); i = content.next(i))
+            ++m;
+        if (m == 0)
+            return;
+        if constexpr (detail::splicing_storage<storage_type>) {
+            if (same_allocator(other)) {
+                other.address.reserve(m);
+                for (auto i = content.next(h); i != content.end_handle(); i = content.next(i)) {
+                    K const& key = content.get(i).first;
+                    address.move_entry_at(address.locate(key), &key, i, other.address);
+                }
+                content.split_after(h, other.content);
+                return;
+            }
+        }
+        // locating a present key builds a lazy index, after which erasing the
+        // copied notes can't throw
+        handle_t first = content.next(h);
+        address.locate(content.get(first).first);
+        if (!other.take_notes(*this, first, m, nullptr, true))
+            erase_block(first, m);
     }
 
-    V& read(K const& k) {
-        if (data_ptr == nullptr)
+    // removes the notes with the given keys, keys that aren't present are skipped
+    template <typename R>
+    void remove_keys(R const& keys) {
+        for (auto const& k : keys) {
+            auto pos = address.locate(k);
+            if (!pos.found)
+                continue;
+            auto note = address.mapped_at(pos);
+            address.erase_at(pos);
+            content.erase(note);
+        }
+    }
+
+    void remove() {
+        if (address.empty())
             throw std::invalid_argument("binder is empty");
+        auto front = content.head();
+        address.erase(content.get(front).first);
+        content.erase(front);
+    }
 
-        auto new_data_ptr = get_new_unique_shared(data_ptr, data_ptr.use_count() == 1);
-        V& res = new_data_ptr->read(k);
-        data_ptr = new_data_ptr;
-        read_called = true;
+    template <typename Q>
+    void remove(Q const& k) {
+        auto pos = address.locate(k);
+        if (!pos.found)
+            throw std::invalid_argument("note doesn't exist in binder");
+        auto note = address.mapped_at(pos);
+        address.erase_at(pos);
+        content.erase(note);
+    }
+
+    template <typename Q>
+    V take(Q const& k) {
+        auto pos = address.locate(k);
+        if (!pos.found)
+            throw std::invalid_argument("note doesn't exist in binder");
+        auto note = address.mapped_at(pos);
+        V res = release_value(content.get(note).second);
+        address.erase_at(pos);
+        content.erase(note);
         return res;
     }
 
-    V const& read(K const& k) const {
-        if (data_ptr == nullptr)
-            throw std::invalid_argument("binder is empty");
+    // the notes in order, moved out if neither K nor V can throw on move, which leaves
+    // this data only fit to be destroyed, otherwise copied; shared values are made
+    // private first, which changes nothing if it throws
+    std::vector<std::pair<K, V>> extract_all() {
+        constexpr bool nothrow_moves = std::is_nothrow_move_constructible_v<K>
+            && std::is_nothrow_move_constructible_v<V>;
+        std::vector<std::pair<K, V>> res;
+        res.reserve(content.size());
+        if constexpr (nothrow_moves && shared_values)
+            for (auto h = content.head(); h != content.end_handle(); h = content.next(h))
+                own(content.get(h).second);
+        for (auto h = content.head(); h != content.end_handle(); h = content.next(h)) {
+            auto& note = content.get(h);
+            if constexpr (nothrow_moves)
+                res.emplace_back(std::move(note.first), std::move(value(note.second)));
+            else
+                res.emplace_back(note.first, value(note.second));
+        }
+        return res;
+    }
 
-        return data_ptr->read_const(k);
+    template <typename Q>
+    V& read(Q const& k) {
+        auto iter = address.find(k);
+        if (iter == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        auto& note = content.get(*iter);
+        return expose(note.first, note.second);
     }
 
-    std::size_t size() const noexcept {
-        return (data_ptr == nullptr) ? 0 : data_ptr->size();
+    template <typename Q>
+    V const& read_const(Q const& k) const {
+        auto iter = address.find(k);
+        if (iter == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        return value(content.get(*iter).second);
     }
 
-    void clear() noexcept {
-        data_ptr = nullptr;
-        read_called = false;
+    // lookups that report a missing key with nullptr or cend() instead of throwing
+
+    template <typename Q>
+    V* read_if(Q const& k) {
+        auto iter = address.find(k);
+        if (iter == nullptr)
+            return nullptr;
+        auto& note = content.get(*iter);
+        return &expose(note.first, note.second);
     }
 
-    class const_iterator;
+    template <typename Q>
+    V const* read_const_if(Q const& k) const {
+        auto iter = address.find(k);
+        return (iter == nullptr) ? nullptr : &value(content.get(*iter).second);
+    }
 
-    const_iterator cbegin() const noexcept {
-        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->cbegin(), data_ptr.get());
+    template <typename Q>
+    const_iterator find(Q const& k) const {
+        auto iter = address.find(k);
+        return (iter == nullptr) ? content.cend() : content.iterator_at(*iter);
     }
 
-    const_iterator cend() const noexcept {
-        return (data_ptr == nullptr) ? const_iterator() : const_iterator(data_ptr->cend(), data_ptr.get());
+    // i must be less than size()
+    const_iterator at_position(std::size_t i) const {
+        if constexpr (detail::order_statistic_storage<storage_type>)
+            return content.iterator_at(content.select(i));
+        else
+            return std::next(content.cbegin(), static_cast<std::ptrdiff_t>(i));
     }
-}; // class binder
 
-template <typename K, typename V>
-class binder<K, V>::binder_data {
+    template <typename Q>
+    std::size_t position_of(Q const& k) const {
+        auto iter = address.find(k);
+        if (iter == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        if constexpr (detail::order_statistic_storage<storage_type>)
+            return content.rank(*iter);
+        else
+            return static_cast<std::size_t>(std::distance(content.cbegin(), content.iterator_at(*iter)));
+    }
 
-    std::list<std::pair<K, V>> content;
-    using list_iterator_t = typename decltype(content)::iterator;
-    std::map<K, list_iterator_t> address;
+    // key and value of the note of an index entry
+    struct note_of_entry {
+        linked_data const* data;
 
-public:
+        template <typename Entry>
+        std::pair<K const&, V const&> operator()(Entry const& e) const noexcept {
+            auto const& note = data->content.get(e.second);
+            return {note.first, value(note.second)};
+        }
+    };
 
-    binder_data() : content{}, address{} {}
+    // notes with keys in [lo, hi) in key order, of data which may be null
+    template <typename Q>
+        requires requires(index_type const& i, Q const& q) { i.range(q, q); }
+    static auto key_range(linked_data const* data, Q const& lo, Q const& hi) {
+        using entries_t = decltype(std::declval<index_type const&>().range(lo, hi));
+        entries_t entries = (data == nullptr) ? entries_t{} : data->address.range(lo, hi);
+        return std::views::transform(std::move(entries), note_of_entry{data});
+    }
 
-    binder_data(binder_data const& rhs) : content{rhs.content}, address{} {
-        for (auto it = content.begin(); it != content.end(); ++it)
-            address.insert(std::make_pair(it->first, it));
+    std::size_t slot_count() const noexcept requires detail::slot_storage<storage_type> {
+        return content.slot_count();
     }
 
-    binder_data(binder_data&& rhs) noexcept : content{std::move(rhs.content)}, address{std::move(rhs.address)} {}
+    // calls fn on the value of every note held in the slots [lo, hi)
+    template <typename F>
+    void visit_slots(std::size_t lo, std::size_t hi, F&& fn) const requires detail::slot_storage<storage_type> {
+        content.visit_slots(lo, hi, [&fn](std::pair<K, stored_value> const& note) {
+            fn(value(note.second));
+        });
+    }
 
-    void insert_front(K const& k, V const& v) {
-        if (address.contains(k))
-            throw std::invalid_argument("binder already contains entry with given key");
-        content.push_front(std::make_pair(k, v));
+    // value blocks are estimated with a shared_ptr control block each
+    std::size_t storage_bytes() const noexcept {
+        std::size_t res = content.memory_usage() + exposed.capacity() * sizeof(K);
+        if constexpr (shared_values)
+            res += content.size() * (sizeof(V) + 2 * sizeof(void*));
+        return res;
+    }
+
+    std::size_t index_bytes() const noexcept {
+        return address.memory_usage();
+    }
+
+    std::size_t size() const noexcept {
+        return content.size();
+    }
+
+    auto cbegin() const noexcept {
+        return content.cbegin();
+    }
+
+    auto cend() const noexcept {
+        return content.cend();
+    }
+
+}; // class binder<K, V, Traits>::linked_data
+
+template <typename K, typename V, typename Traits>
+class binder<K, V, Traits>::persistent_data : public share_state {
+
+    static_assert(!Traits::values::shared, "persistent_storage shares values by itself, use inline_values");
+
+    using storage_type = detail::persistent_list<K, V, allocator_type>;
+
+    storage_type content;
+
+    // inserts the pair-like elements of [first, last) as consecutive notes after
+    // *prev_k, or at the front if prev_k is nullptr; either all of them are inserted or none
+    template <typename It, typename S>
+    void insert_block(K const* prev_k, It first, S last) {
+        std::optional<K> tail;
+        if (prev_k != nullptr)
+            tail = *prev_k;
+        auto saved = content.save();
         try {
-            address.emplace(std::make_pair(k, content.begin()));
+            for (; first != last; ++first) {
+                auto&& e = *first;
+                if (content.contains(std::get<0>(e)))
+                    throw std::invalid_argument("binder already contains entry with given key");
+                if (!tail) {
+                    content.emplace_front(std::get<0>(std::forward<decltype(e)>(e)), std::get<1>(std::forward<decltype(e)>(e)));
+                    tail = content.front();
+                }
+                else {
+                    content.emplace_after(*tail, std::get<0>(std::forward<decltype(e)>(e)), std::get<1>(std::forward<decltype(e)>(e)));
+                    tail = *content.next_of(*tail);
+                }
+            }
         }
         catch (...) {
-            content.pop_front();
+            content.restore(std::move(saved));
             throw;
         }
     }
 
-    void insert_after(K const& prev_k, K const& k, V const& v) {
-        if (address.contains(k))
-            throw std::invalid_argument("binder already contains entry with given key");
-        
-        if (!address.contains(prev_k))
+public:
+
+    using const_iterator = typename storage_type::const_iterator;
+
+    static K const& key_of(const_iterator const& it) noexcept {
+        return it.key();
+    }
+
+    static V const& value_of(const_iterator const& it) noexcept {
+        return it.value();
+    }
+
+    explicit persistent_data(allocator_type const& a) : content{a} {}
+
+    persistent_data(persistent_data const& rhs, allocator_type const& a)
+        : share_state{rhs}, content{rhs.content, a} {}
+
+    persistent_data(persistent_data&& rhs) noexcept : content{std::move(rhs.content)} {}
+
+    // notes made from the pair-like elements of [first, last) in that order
+    template <typename It, typename S>
+    persistent_data(It first, S last, allocator_type const& a) : content{a} {
+        insert_block(nullptr, std::move(first), std::move(last));
+    }
+
+    template <typename KK, typename... Args>
+    insert_status try_emplace_front(KK&& k, Args&&... args) {
+        if (content.contains(k))
+            return insert_status::key_exists;
+        content.emplace_front(std::forward<KK>(k), std::forward<Args>(args)...);
+        return insert_status::inserted;
+    }
+
+    template <typename KK, typename... Args>
+    insert_status try_emplace_after(K const& prev_k, KK&& k, Args&&... args) {
+        if (content.contains(k))
+            return insert_status::key_exists;
+        if (!content.contains(prev_k))
+            return insert_status::previous_missing;
+        content.emplace_after(prev_k, std::forward<KK>(k), std::forward<Args>(args)...);
+        return insert_status::inserted;
+    }
+
+    template <typename Q>
+    static constexpr bool accepts = detail::ordered_with<K, Q>;
+
+    template <typename Q>
+    bool contains(Q const& k) const {
+        return content.contains(k);
+    }
+
+    template <typename It, typename S>
+    void insert_range_front(It first, S last) {
+        insert_block(nullptr, std::move(first), std::move(last));
+    }
+
+    template <typename It, typename S>
+    void insert_range_after(K const& prev_k, It first, S last) {
+        if (!content.contains(prev_k))
             throw std::invalid_argument("binder doesn't contain previous entry");
-        auto prev_iter = address.find(prev_k)->second;
-        ++prev_iter;
-        auto new_iter = content.insert(prev_iter, std::make_pair(k, v));
-        try {
-            address.insert(std::make_pair(k, new_iter));
-        }
-        catch (...) {
-            content.erase(new_iter);
-            throw;
-        }
+        insert_block(&prev_k, std::move(first), std::move(last));
+    }
+
+    // copies the notes of other after the note with key *prev_k, or to the front if prev_k
+    // is nullptr; none of their keys may be present. Values are copied, the trees can't be
+    // relinked
+    void splice(K const* prev_k, persistent_data const& other, bool) {
+        std::vector<std::pair<K const&, V const&>> notes;
+        notes.reserve(other.content.size());
+        for (auto it = other.content.cbegin(); it != other.content.cend(); ++it)
+            notes.emplace_back(it.key(), it.value());
+        insert_block(prev_k, notes.begin(), notes.end());
+    }
+
+    // moves the notes following the note with key k into other, which must be empty; the
+    // notes are erased from a copy of the tree, which replaces it only once all succeeded
+    void split_after(K const& k, persistent_data& other) {
+        std::vector<std::pair<K const&, V const&>> notes;
+        for (auto it = ++content.iterator_at(k); it != content.cend(); ++it)
+            notes.emplace_back(it.key(), it.value());
+        if (notes.empty())
+            return;
+        other.insert_block(nullptr, notes.begin(), notes.end());
+        storage_type rest{content, content.get_allocator()};
+        for (auto it = other.content.cbegin(); it != other.content.cend(); ++it)
+            rest.erase(it.key());
+        content.swap(rest);
+    }
+
+    // removes the notes with the given keys, keys that aren't present are skipped
+    template <typename R>
+    void remove_keys(R const& keys) {
+        for (auto const& k : keys)
+            if (content.contains(k))
+                content.erase(k);
     }
 
     void remove() {
-        if (address.empty())
+        if (!content.size())
             throw std::invalid_argument("binder is empty");
-        address.erase(content.begin()->first);
-        content.erase(content.begin());
+        content.erase(content.front());
     }
 
-    void remove(K const& k) {
-        if (!address.contains(k))
+    // the tree is modified through the stored key equal to k
+    template <typename Q>
+    void remove(Q const& k) {
+        K const* key = content.stored_key(k);
+        if (key == nullptr)
             throw std::invalid_argument("note doesn't exist in binder");
-        auto iter = address.find(k)->second;
-        content.erase(iter);
-        address.erase(k);
+        content.erase(*key);
     }
 
-    V& read(K const& k) {
-        auto iter = address.find(k);
-        if (iter == address.end())
+    // the tree may share the note with other data, so its value is copied
+    template <typename Q>
+    V take(Q const& k) {
+        V res = read_const(k);
+        remove(k);
+        return res;
+    }
+
+    std::vector<std::pair<K, V>> extract_all() const {
+        std::vector<std::pair<K, V>> res;
+        res.reserve(content.size());
+        for (auto it = content.cbegin(); it != content.cend(); ++it)
+            res.emplace_back(it.key(), it.value());
+        return res;
+    }
+
+    template <typename Q>
+    V& read(Q const& k) {
+        K const* key = content.stored_key(k);
+        if (key == nullptr)
             throw std::invalid_argument("note doesn't exist in binder");
-        return iter->second->second;
+        return *content.expose(*key);
     }
 
-    V const& read_const(K const& k) const {
-        auto iter = address.find(k);
-        if (iter == address.end())
+    template <typename Q>
+    V const& read_const(Q const& k) const {
+        V const* res = content.find(k);
+        if (res == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        return *res;
+    }
+
+    // lookups that report a missing key with nullptr or cend() instead of throwing
+
+    template <typename Q>
+    V* read_if(Q const& k) {
+        K const* key = content.stored_key(k);
+        return (key == nullptr) ? nullptr : content.expose(*key);
+    }
+
+    template <typename Q>
+    V const* read_const_if(Q const& k) const {
+        return content.find(k);
+    }
+
+    template <typename Q>
+    const_iterator find(Q const& k) const {
+        return content.iterator_at(k);
+    }
+
+    // i must be less than size()
+    const_iterator at_position(std::size_t i) const {
+        auto it = content.cbegin();
+        while (i--)
+            ++it;
+        return it;
+    }
+
+    template <typename Q>
+    std::size_t position_of(Q const& k) const {
+        auto target = content.iterator_at(k);
+        if (target == content.cend())
             throw std::invalid_argument("note doesn't exist in binder");
-        return iter->second->second;
+        std::size_t res = 0;
+        for (auto it = content.cbegin(); it != target; ++it)
+            ++res;
+        return res;
+    }
+
+    std::size_t storage_bytes() const noexcept {
+        return content.memory_usage();
+    }
+
+    // the tree is its own index
+    std::size_t index_bytes() const noexcept {
+        return 0;
     }
 
     std::size_t size() const noexcept {
@@ -238,71 +4763,113 @@ public:
         return content.cend();
     }
 
-}; // class binder<K, V>::binder_data
+}; // class binder<K, V, Traits>::persistent_data
 
-template <typename K, typename V>
-class binder<K, V>::const_iterator {
-    using list_iterator_t = typename std::list<std::pair<K, V>>::const_iterator;
+// mutable reference to a note that keeps the binder unshareable while it lives;
+// it is invalidated like a reference returned by read(), and holds on to the data
+// it pins so that it can outlive the binder or the binder's data
+template <typename K, typename V, typename Traits>
+class binder<K, V, Traits>::write_handle {
 
-    friend class binder<K, V>;
+    friend class binder<K, V, Traits>;
 
-    std::optional<list_iterator_t> list_iterator;
+    data_pointer data;
+    V* value;
 
-    // pointer to 
-    binder<K, V>::binder_data const* obj_ptr;
+    write_handle(data_pointer d, V& v) noexcept : data{std::move(d)}, value{&v} {
+        data->pin();
+    }
 
-    // is only used with it equal to the cbegin() of some list and therefore never throws
-    explicit const_iterator(list_iterator_t it, auto* obj_id) noexcept : list_iterator{it}, obj_ptr{obj_id} {}
+public:
+
+    write_handle(write_handle&& rhs) noexcept
+        : data{std::move(rhs.data)}, value{std::exchange(rhs.value, nullptr)} {
+        rhs.data = nullptr;
+    }
+
+    write_handle(write_handle const&) = delete;
+    write_handle& operator=(write_handle const&) = delete;
+    write_handle& operator=(write_handle&&) = delete;
+
+    ~write_handle() noexcept {
+        if (data != nullptr)
+            data->unpin();
+    }
+
+    V& operator*() const noexcept {
+        return *value;
+    }
+
+    V* operator->() const noexcept {
+        return value;
+    }
+}; // class binder<K, V, Traits>::write_handle
 
+template <typename K, typename V, typename Traits>
+class binder<K, V, Traits>::const_iterator {
+    using list_iterator_t = typename binder_data::const_iterator;
+
+    friend class binder<K, V, Traits>;
+
+    list_iterator_t list_iterator;
+
+    // data the iterator walks, nullptr for iterators of an empty binder
+    binder<K, V, Traits>::binder_data const* obj_ptr;
+
+    explicit const_iterator(list_iterator_t it, auto* obj_id) noexcept : list_iterator{it}, obj_ptr{obj_id} {}
 
 public:
-    using iterator_category = std::forward_iterator_tag;
+    using iterator_category = std::bidirectional_iterator_tag;
     using value_type = V;
     using difference_type = std::ptrdiff_t;
+    using pointer = V const*;
+    using reference = V const&;
 
     explicit const_iterator() noexcept : list_iterator{}, obj_ptr{} {}
 
-    const_iterator(const_iterator const& rhs) : list_iterator{rhs.list_iterator}, obj_ptr{rhs.obj_ptr}  {}
-    
     V const& operator*() const noexcept {
-        return list_iterator.value()->second;
+        return binder_data::value_of(list_iterator);
     }
 
     V const* operator->() const noexcept {
-        return &(list_iterator.value()->second);
+        return &binder_data::value_of(list_iterator);
     }
 
-    const_iterator& operator=(const_iterator const& rhs) {
-        list_iterator = rhs.list_iterator;
-        obj_ptr = rhs.obj_ptr;
-        return *this;
+    K const& key() const noexcept {
+        return binder_data::key_of(list_iterator);
     }
 
-    const_iterator& operator=(const_iterator&& rhs) {
-        list_iterator = std::move(rhs.list_iterator);
-        obj_ptr = std::move(rhs.obj_ptr);
-        return *this;
+    // key and value of the note
+    std::pair<K const&, V const&> note() const noexcept {
+        return {key(), **this};
     }
 
     bool operator==(const_iterator const& rhs) const noexcept {
         return obj_ptr == rhs.obj_ptr && list_iterator == rhs.list_iterator;
     }
 
-    bool operator!=(const_iterator const& rhs) const noexcept {
-        return !(*this == rhs);
-    }
-
     const_iterator& operator++() noexcept {
-        ++list_iterator.value();
+        ++list_iterator;
         return *this;
     }
 
     const_iterator operator++(int) noexcept {
         auto tmp = *this;
-        ++list_iterator.value();
+        ++list_iterator;
+        return tmp;
+    }
+
+    const_iterator& operator--() noexcept {
+        --list_iterator;
+        return *this;
+    }
+
+    const_iterator operator--(int) noexcept {
+        auto tmp = *this;
+        --list_iterator;
         return tmp;
     }
-}; // class binder<K, V>::const_iterator
+}; // class binder<K, V, Traits>::const_iterator
 
 } // namespace cxx
 
@@ -0,0 +1,301 @@
+#ifndef BINDER_IO_H
+#define BINDER_IO_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "binder.h"
+
+namespace cxx {
+
+// binary image of the notes of a binder with trivially copyable keys and values, in the
+// byte order and layout of the machine that wrote it:
+//     header, keys in note order, values in note order, and for ordered keys the
+//     positions of the notes sorted by key, which let mapped_binder look keys up;
+// every section starts at a multiple of image_header::alignment
+struct image_header {
+    static constexpr std::uint32_t expected_magic = 0x52444e42; // "BNDR" little endian
+    static constexpr std::uint32_t current_version = 1;
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t count;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::uint32_t alignment;
+    std::uint32_t reserved;
+    std::uint64_t keys_offset;
+    std::uint64_t values_offset;
+    // 0 if the keys are not ordered
+    std::uint64_t order_offset;
+    std::uint64_t total_size;
+};
+
+namespace detail {
+
+template <typename K, typename V>
+concept image_notes = std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>;
+
+template <typename K, typename V>
+inline constexpr std::size_t image_alignment =
+    std::max({alignof(K), alignof(V), alignof(std::uint64_t), alignof(image_header)});
+
+constexpr std::uint64_t align_up(std::uint64_t n, std::uint64_t a) noexcept {
+    return (n + a - 1) / a * a;
+}
+
+template <typename K, typename V>
+image_header make_image_header(std::uint64_t count) noexcept {
+    constexpr std::uint64_t a = image_alignment<K, V>;
+    image_header h{};
+    h.magic = image_header::expected_magic;
+    h.version = image_header::current_version;
+    h.count = count;
+    h.key_size = sizeof(K);
+    h.value_size = sizeof(V);
+    h.alignment = a;
+    h.keys_offset = align_up(sizeof(image_header), a);
+    h.values_offset = align_up(h.keys_offset + count * sizeof(K), a);
+    std::uint64_t end = h.values_offset + count * sizeof(V);
+    if constexpr (std::totally_ordered<K>) {
+        h.order_offset = align_up(end, a);
+        end = h.order_offset + count * sizeof(std::uint64_t);
+    }
+    h.total_size = end;
+    return h;
+}
+
+// header of image, checked against K and V and the size of image
+template <typename K, typename V>
+image_header read_image_header(std::span<std::byte const> image) {
+    image_header h;
+    if (image.size() < sizeof(h))
+        throw std::invalid_argument("binder image is truncated");
+    std::memcpy(&h, image.data(), sizeof(h));
+    if (h.magic != image_header::expected_magic)
+        throw std::invalid_argument("not a binder image or written with other byte order");
+    if (h.version != image_header::current_version)
+        throw std::invalid_argument("unsupported binder image version");
+    if (h.key_size != sizeof(K) || h.value_size != sizeof(V))
+        throw std::invalid_argument("binder image holds notes of other types");
+    if (h.count > image.size() || h.total_size > image.size())
+        throw std::invalid_argument("binder image is truncated");
+    auto expected = make_image_header<K, V>(h.count);
+    if (h.alignment != expected.alignment || h.keys_offset != expected.keys_offset
+        || h.values_offset != expected.values_offset || h.total_size < expected.total_size
+        || (h.order_offset != 0 && h.order_offset != expected.order_offset))
+        throw std::invalid_argument("binder image is corrupted");
+    return h;
+}
+
+// i-th object of type T of the section at offset, which may be unaligned; made from
+// its bytes, so that T needn't be default constructible
+template <typename T>
+T image_element(std::span<std::byte const> image, std::uint64_t offset, std::uint64_t i) noexcept {
+    std::array<std::byte, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), image.data() + offset + i * sizeof(T), sizeof(T));
+    return std::bit_cast<T>(bytes);
+}
+
+} // namespace detail
+
+// writes the image of b to sink, which is called with consecutive std::span<std::byte const>
+template <typename K, typename V, typename Traits, typename Sink>
+    requires detail::image_notes<K, V> && std::invocable<Sink&, std::span<std::byte const>>
+void serialize(binder<K, V, Traits> const& b, Sink&& sink) {
+    auto const h = detail::make_image_header<K, V>(b.size());
+    std::uint64_t written = 0;
+    auto put = [&sink, &written](void const* p, std::size_t n) {
+        std::invoke(sink, std::span<std::byte const>(static_cast<std::byte const*>(p), n));
+        written += n;
+    };
+    auto pad_to = [&put, &written](std::uint64_t offset) {
+        static constexpr std::array<std::byte, detail::image_alignment<K, V>> zeros{};
+        put(zeros.data(), offset - written);
+    };
+
+    put(&h, sizeof(h));
+    pad_to(h.keys_offset);
+    for (auto it = b.cbegin(); it != b.cend(); ++it)
+        put(&it.key(), sizeof(K));
+    pad_to(h.values_offset);
+    for (auto it = b.cbegin(); it != b.cend(); ++it)
+        put(&*it, sizeof(V));
+
+    if constexpr (std::totally_ordered<K>) {
+        std::vector<std::pair<K, std::uint64_t>> sorted;
+        sorted.reserve(h.count);
+        for (auto it = b.cbegin(); it != b.cend(); ++it)
+            sorted.emplace_back(it.key(), sorted.size());
+        std::ranges::sort(sorted, std::less<>{}, [](auto const& e) -> K const& { return e.first; });
+        pad_to(h.order_offset);
+        for (auto const& e : sorted)
+            put(&e.second, sizeof(e.second));
+    }
+}
+
+template <typename K, typename V, typename Traits>
+    requires detail::image_notes<K, V>
+void serialize(binder<K, V, Traits> const& b, std::ostream& os) {
+    serialize(b, [&os](std::span<std::byte const> bytes) {
+        os.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    });
+    if (!os)
+        throw std::runtime_error("writing binder image failed");
+}
+
+// binder with the notes of image, built in one pass without per-note lookups;
+// image needn't be aligned
+template <typename Binder>
+Binder load(std::span<std::byte const> image,
+    typename Binder::allocator_type const& a = typename Binder::allocator_type()) {
+    using K = typename Binder::key_type;
+    using V = typename Binder::value_type;
+    static_assert(detail::image_notes<K, V>, "binder images require trivially copyable keys and values");
+
+    auto const h = detail::read_image_header<K, V>(image);
+    auto notes = std::views::iota(std::uint64_t{0}, h.count)
+        | std::views::transform([image, &h](std::uint64_t i) {
+            return std::pair<K, V>{detail::image_element<K>(image, h.keys_offset, i),
+                detail::image_element<V>(image, h.values_offset, i)};
+        });
+    return Binder(from_range, notes, a);
+}
+
+// read-only binder served directly from an image, e.g. a memory-mapped file, without
+// copying it; the image must outlive the view and be aligned to image_header::alignment
+template <typename K, typename V>
+    requires detail::image_notes<K, V> && std::totally_ordered<K>
+class mapped_binder {
+
+    std::span<std::byte const> image;
+    std::size_t count;
+    K const* keys;
+    V const* values;
+    // indices of the notes sorted by key
+    std::uint64_t const* order;
+
+public:
+
+    class const_iterator {
+
+        friend class mapped_binder;
+
+        mapped_binder const* owner;
+        std::size_t pos;
+
+        const_iterator(mapped_binder const* o, std::size_t p) noexcept : owner{o}, pos{p} {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = V;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() noexcept : owner{}, pos{} {}
+
+        V const& operator*() const noexcept {
+            return owner->values[pos];
+        }
+
+        V const* operator->() const noexcept {
+            return owner->values + pos;
+        }
+
+        K const& key() const noexcept {
+            return owner->keys[pos];
+        }
+
+        const_iterator& operator++() noexcept {
+            ++pos;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++pos;
+            return tmp;
+        }
+
+        bool operator==(const_iterator const& rhs) const noexcept {
+            return owner == rhs.owner && pos == rhs.pos;
+        }
+    }; // class mapped_binder::const_iterator
+
+    explicit mapped_binder(std::span<std::byte const> img) : image{img} {
+        auto const h = detail::read_image_header<K, V>(image);
+        if (h.order_offset == 0)
+            throw std::invalid_argument("binder image has no key order");
+        if (reinterpret_cast<std::uintptr_t>(image.data()) % h.alignment != 0)
+            throw std::invalid_argument("binder image is misaligned");
+        count = static_cast<std::size_t>(h.count);
+        keys = reinterpret_cast<K const*>(image.data() + h.keys_offset);
+        values = reinterpret_cast<V const*>(image.data() + h.values_offset);
+        order = reinterpret_cast<std::uint64_t const*>(image.data() + h.order_offset);
+        for (std::size_t i = 0; i < count; ++i)
+            if (order[i] >= count)
+                throw std::invalid_argument("binder image is corrupted");
+    }
+
+    // O(log n) binary search over the stored key order
+    V const& read(K const& k) const {
+        auto p = locate(k);
+        if (p == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        return *p;
+    }
+
+    bool contains(K const& k) const noexcept {
+        return locate(k) != nullptr;
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, count);
+    }
+
+    // copy of the notes as an ordinary binder
+    template <typename Traits = default_binder_traits>
+    binder<K, V, Traits> to_binder(typename binder<K, V, Traits>::allocator_type const& a = {}) const {
+        return load<binder<K, V, Traits>>(image, a);
+    }
+
+private:
+
+    V const* locate(K const& k) const noexcept {
+        auto first = order;
+        auto last = order + count;
+        auto it = std::partition_point(first, last, [this, &k](std::uint64_t i) { return keys[i] < k; });
+        if (it == last || k < keys[*it])
+            return nullptr;
+        return values + *it;
+    }
+}; // class mapped_binder
+
+} // namespace cxx
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef CONCURRENT_BINDER_H
+#define CONCURRENT_BINDER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <type_traits>
+#include <functional>
+
+#include "binder.h"
+
+namespace cxx {
+
+// binder shared between threads: readers take an immutable snapshot with a single
+// atomic load, writers are serialized and publish a new version when done;
+// a snapshot stays valid and unchanged for as long as it is held
+template <typename K, typename V, typename Traits = default_binder_traits>
+class concurrent_binder {
+
+    static_assert(Traits::refcount::thread_safe,
+        "concurrent_binder requires a thread-safe refcount policy");
+
+public:
+
+    using binder_type = binder<K, V, Traits>;
+    using snapshot_type = std::shared_ptr<binder_type const>;
+    using allocator_type = typename binder_type::allocator_type;
+
+private:
+
+    std::atomic<snapshot_type> current;
+
+    // serializes writers, readers never take it
+    std::mutex writer;
+
+    // runs fn on a private copy of the current version and publishes the result;
+    // the copy shares notes with the published version until fn modifies it
+    template <typename F>
+    auto write_version(F&& fn) {
+        std::lock_guard lock{writer};
+        auto next = std::make_shared<binder_type>(*current.load(std::memory_order_relaxed));
+        if constexpr (std::is_void_v<std::invoke_result_t<F, binder_type&>>) {
+            std::invoke(std::forward<F>(fn), *next);
+            current.store(std::move(next), std::memory_order_release);
+        }
+        else {
+            auto res = std::invoke(std::forward<F>(fn), *next);
+            current.store(std::move(next), std::memory_order_release);
+            return res;
+        }
+    }
+
+public:
+
+    concurrent_binder() : current{std::make_shared<binder_type const>()} {}
+
+    explicit concurrent_binder(allocator_type const& a) : current{std::make_shared<binder_type const>(a)} {}
+
+    explicit concurrent_binder(binder_type b) : current{std::make_shared<binder_type const>(std::move(b))} {}
+
+    concurrent_binder(concurrent_binder const&) = delete;
+    concurrent_binder& operator=(concurrent_binder const&) = delete;
+
+    // current version, unaffected by later writes
+    snapshot_type snapshot() const noexcept {
+        return current.load(std::memory_order_acquire);
+    }
+
+    // applies fn(binder_type&) atomically with respect to other writers and
+    // returns a copy of its result, a reference could point into the published
+    // version; readers see either none or all of its changes
+    template <typename F>
+    auto update(F&& fn) {
+        return write_version(std::forward<F>(fn));
+    }
+
+    // replaces the current version with b
+    void store(binder_type b) {
+        std::lock_guard lock{writer};
+        current.store(std::make_shared<binder_type const>(std::move(b)), std::memory_order_release);
+    }
+
+    void insert_front(K const& k, V const& v) {
+        update([&](binder_type& b) { b.insert_front(k, v); });
+    }
+
+    void insert_after(K const& prev_k, K const& k, V const& v) {
+        update([&](binder_type& b) { b.insert_after(prev_k, k, v); });
+    }
+
+    insert_status try_insert_front(K const& k, V const& v) {
+        return update([&](binder_type& b) { return b.try_insert_front(k, v); });
+    }
+
+    insert_status try_insert_after(K const& prev_k, K const& k, V const& v) {
+        return update([&](binder_type& b) { return b.try_insert_after(prev_k, k, v); });
+    }
+
+    void remove() {
+        update([](binder_type& b) { b.remove(); });
+    }
+
+    void remove(K const& k) {
+        update([&](binder_type& b) { b.remove(k); });
+    }
+
+    void clear() {
+        store(binder_type{snapshot()->get_allocator()});
+    }
+
+    // returns a copy, a reference could outlive the version it points into
+    V read(K const& k) const {
+        return snapshot()->read(k);
+    }
+
+    std::size_t size() const noexcept {
+        return snapshot()->size();
+    }
+}; // class concurrent_binder
+
+} // namespace cxx
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef SHARDED_BINDER_H
+#define SHARDED_BINDER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <functional>
+#include <stdexcept>
+#include <bit>
+#include <vector>
+
+#include "binder.h"
+
+namespace cxx {
+
+// binder for many concurrent writers: the key index is split into Shards independently
+// locked hash shards, so lookups, duplicate checks and note construction of different
+// keys proceed in parallel; the global note order is a doubly linked list whose links
+// are only spliced under a short global lock
+template <typename K, typename V, std::size_t Shards = 16, typename Hash = std::hash<K>>
+class sharded_binder {
+
+    static_assert(std::has_single_bit(Shards), "number of shards must be a power of two");
+
+    struct node {
+        K key;
+        V value;
+        node* prev;
+        node* next;
+
+        template <typename KK, typename VV>
+        node(KK&& k, VV&& v) : key(std::forward<KK>(k)), value(std::forward<VV>(v)), prev{}, next{} {}
+    };
+
+    // kept on separate cache lines so that writers of different shards don't contend
+    struct alignas(64) shard {
+        mutable std::shared_mutex lock;
+        detail::flat_hash_index<K, node*, std::allocator<std::byte>, Hash> index;
+    };
+
+    std::array<shard, Shards> shards;
+
+    // guards head and the prev/next links of every note;
+    // always taken after the shard locks, never before
+    mutable std::mutex link_lock;
+    node* head;
+
+    std::atomic<std::size_t> count;
+
+    [[no_unique_address]] Hash hasher;
+
+    std::size_t shard_of(K const& k) const noexcept {
+        // above the bits the shard index uses for probing
+        auto x = static_cast<std::uint64_t>(hasher(k)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(x >> 32) & (Shards - 1);
+    }
+
+    void link_front(node* n) noexcept {
+        std::lock_guard lock{link_lock};
+        n->next = head;
+        if (head != nullptr)
+            head->prev = n;
+        head = n;
+    }
+
+    void link_after(node* prev, node* n) noexcept {
+        std::lock_guard lock{link_lock};
+        n->prev = prev;
+        n->next = prev->next;
+        if (prev->next != nullptr)
+            prev->next->prev = n;
+        prev->next = n;
+    }
+
+    void unlink(node* n) noexcept {
+        std::lock_guard lock{link_lock};
+        if (n->prev != nullptr)
+            n->prev->next = n->next;
+        else
+            head = n->next;
+        if (n->next != nullptr)
+            n->next->prev = n->prev;
+    }
+
+    // inserts n into its shard, which must be locked by the caller, and links it
+    // with link, which mustn't throw
+    template <typename Link>
+    void publish(shard& s, std::unique_ptr<node> n, Link link) {
+        auto pos = s.index.locate(n->key);
+        if (pos.found)
+            throw std::invalid_argument("binder already contains entry with given key");
+        s.index.insert_at(pos, &n->key, n.get());
+        link(n.release());
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // locks every shard in ascending order, then the links
+    auto lock_all() const {
+        std::array<std::unique_lock<std::shared_mutex>, Shards> locks;
+        for (std::size_t i = 0; i < Shards; ++i)
+            locks[i] = std::unique_lock{shards[i].lock};
+        return std::pair{std::move(locks), std::unique_lock{link_lock}};
+    }
+
+public:
+
+    sharded_binder() : head{}, count{}, hasher{} {}
+
+    sharded_binder(sharded_binder const&) = delete;
+    sharded_binder& operator=(sharded_binder const&) = delete;
+
+    ~sharded_binder() noexcept {
+        while (head != nullptr)
+            delete std::exchange(head, head->next);
+    }
+
+    void insert_front(K const& k, V const& v) {
+        auto n = std::make_unique<node>(k, v);
+        shard& s = shards[shard_of(k)];
+        std::unique_lock lock{s.lock};
+        publish(s, std::move(n), [this](node* p) { link_front(p); });
+    }
+
+    // insertions after different notes only serialize on the link splice
+    void insert_after(K const& prev_k, K const& k, V const& v) {
+        auto n = std::make_unique<node>(k, v);
+        std::size_t i = shard_of(prev_k);
+        std::size_t j = shard_of(k);
+        shard& s = shards[j];
+        // the note of prev_k must not be removed until the new one is linked
+        std::unique_lock first_lock{shards[std::min(i, j)].lock};
+        std::unique_lock<std::shared_mutex> second_lock;
+        if (i != j)
+            second_lock = std::unique_lock{shards[std::max(i, j)].lock};
+
+        node* const* prev = shards[i].index.find(prev_k);
+        if (prev == nullptr)
+            throw std::invalid_argument("binder doesn't contain previous entry");
+        publish(s, std::move(n), [this, p = *prev](node* q) { link_after(p, q); });
+    }
+
+    void remove(K const& k) {
+        shard& s = shards[shard_of(k)];
+        node* n;
+        {
+            std::unique_lock lock{s.lock};
+            auto pos = s.index.locate(k);
+            if (!pos.found)
+                throw std::invalid_argument("note doesn't exist in binder");
+            n = s.index.mapped_at(pos);
+            s.index.erase_at(pos);
+            unlink(n);
+            count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        delete n;
+    }
+
+    // returns a copy, a reference could be invalidated by a concurrent remove
+    V read(K const& k) const {
+        shard const& s = shards[shard_of(k)];
+        std::shared_lock lock{s.lock};
+        node* const* n = s.index.find(k);
+        if (n == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        return (*n)->value;
+    }
+
+    bool contains(K const& k) const {
+        shard const& s = shards[shard_of(k)];
+        std::shared_lock lock{s.lock};
+        return s.index.contains(k);
+    }
+
+    // calls fn with a mutable reference to the note with key k while its shard is locked;
+    // its result is returned by value, since a reference would outlive the lock
+    template <typename F>
+    std::remove_cvref_t<std::invoke_result_t<F, V&>> modify(K const& k, F&& fn) {
+        shard& s = shards[shard_of(k)];
+        std::unique_lock lock{s.lock};
+        node** n = s.index.find(k);
+        if (n == nullptr)
+            throw std::invalid_argument("note doesn't exist in binder");
+        return std::invoke(std::forward<F>(fn), (*n)->value);
+    }
+
+    // calls fn(key, value) for every note in order on a consistent state;
+    // stops all writers for the duration
+    template <typename F>
+    void for_each(F&& fn) const {
+        auto locks = lock_all();
+        for (node const* n = head; n != nullptr; n = n->next)
+            std::invoke(fn, std::as_const(n->key), std::as_const(n->value));
+    }
+
+    // copy of the current content as a single-threaded binder
+    template <typename Traits = default_binder_traits>
+    binder<K, V, Traits> to_binder() const {
+        std::vector<std::pair<K, V>> notes;
+        notes.reserve(size());
+        for_each([&notes](K const& k, V const& v) { notes.emplace_back(k, v); });
+        return binder<K, V, Traits>(from_range, std::move(notes));
+    }
+
+    std::size_t size() const noexcept {
+        return count.load(std::memory_order_relaxed);
+    }
+}; // class sharded_binder
+
+} // namespace cxx
+
+#endif
@@ -0,0 +1,97 @@
+#include <string>
+#include <vector>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+template <typename Index, typename Storage>
+struct pmr_traits : pmr::binder_traits {
+    using index = Index;
+    using storage = Storage;
+};
+
+// the notes, the index and the shared block all come from the binder's resource,
+// and go back to it
+template <typename Traits>
+void allocates_from_resource() {
+    test::counting_resource res;
+    {
+        binder<int, int, Traits> b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+        for (int i = 0; i < 100; ++i)
+            b.insert_front(i, i);
+        CHECK(res.in_use > 0);
+        CHECK(b.get_allocator().resource() == &res);
+
+        // polymorphic_allocator selects the default resource for a copy
+        auto held = res.in_use;
+        auto copy = b;
+        copy.remove(5);
+        CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+        CHECK(res.in_use == held);
+        CHECK(b.size() == 100 && copy.size() == 99);
+    }
+    CHECK(res.in_use == 0);
+}
+
+// a copy made with another allocator places its clones there, the source keeps its own
+template <typename Traits>
+void copy_with_allocator() {
+    test::counting_resource first;
+    test::counting_resource second;
+    {
+        binder<int, int, Traits> a{std::pmr::polymorphic_allocator<std::byte>{&first}};
+        for (int i = 0; i < 100; ++i)
+            a.insert_front(i, i);
+        auto held_by_first = first.in_use;
+
+        binder<int, int, Traits> b{a, std::pmr::polymorphic_allocator<std::byte>{&second}};
+        CHECK(second.allocations == 0);
+        b.insert_front(-1, -1);
+        CHECK(second.in_use > 0);
+        CHECK(first.in_use == held_by_first);
+        CHECK(a.size() == 100 && b.size() == 101);
+    }
+    CHECK(first.in_use == 0 && second.in_use == 0);
+}
+
+// std::pmr::polymorphic_allocator doesn't propagate, an assigned binder keeps its resource
+template <typename Traits>
+void assignment_keeps_resource() {
+    test::counting_resource first;
+    test::counting_resource second;
+    {
+        binder<int, int, Traits> a{std::pmr::polymorphic_allocator<std::byte>{&first}};
+        binder<int, int, Traits> b{std::pmr::polymorphic_allocator<std::byte>{&second}};
+        a.insert_front(1, 1);
+        b = a;
+        CHECK(b.get_allocator().resource() == &second);
+        b.insert_front(2, 2);
+        CHECK(second.in_use > 0);
+        CHECK(a.size() == 1 && b.size() == 2);
+    }
+    CHECK(first.in_use == 0 && second.in_use == 0);
+}
+
+} // namespace
+
+int main() {
+    allocates_from_resource<pmr_traits<ordered_index, list_storage>>();
+    allocates_from_resource<pmr_traits<hash_index, slab_storage>>();
+    allocates_from_resource<pmr_traits<ordered_index, persistent_storage>>();
+    copy_with_allocator<pmr_traits<ordered_index, list_storage>>();
+    copy_with_allocator<pmr_traits<hash_index, slab_storage>>();
+    assignment_keeps_resource<pmr_traits<hash_index, list_storage>>();
+
+    test::counting_resource res;
+    {
+        pmr::binder<std::pmr::string, int> b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+        b.insert_front(std::pmr::string{"a key that doesn't fit the small string buffer"}, 1);
+        CHECK(b.contains(std::pmr::string{"a key that doesn't fit the small string buffer"}));
+    }
+    CHECK(res.in_use == 0);
+}
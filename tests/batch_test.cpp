@@ -0,0 +1,214 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// copyable value whose copies throw once the budget runs out
+struct fragile {
+    static inline long budget = -1;
+
+    int v;
+
+    fragile(int x) : v{x} {}
+
+    fragile(fragile const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+    }
+
+    fragile& operator=(fragile const&) = default;
+};
+
+struct lazy_hash_pmr_traits : test::lazy_pmr_traits {
+    using index = lazy_index<hash_index>;
+    using storage = slab_storage;
+};
+
+using notes = std::vector<std::pair<int, fragile>>;
+
+template <typename B>
+B make(int n) {
+    B b;
+    for (int i = n - 1; i >= 0; --i)
+        b.insert_front(i, fragile{i});
+    return b;
+}
+
+std::uint64_t write_clones() {
+    return global_clone_counters.on_write.load();
+}
+
+template <typename Traits>
+void inserts_and_removes_in_order() {
+    using B = binder<int, fragile, Traits>;
+    auto b = make<B>(3);
+    notes front{{10, 10}, {11, 11}};
+    notes middle{{20, 20}, {21, 21}, {22, 22}};
+    b.insert_front_range(front.begin(), front.end());
+    b.insert_after_range(1, middle.begin(), middle.end());
+    CHECK((test::keys_of(b) == std::vector<int>{10, 11, 0, 1, 20, 21, 22, 2}));
+
+    b.remove_keys(std::vector<int>{11, 21, 2, 21});
+    CHECK((test::keys_of(b) == std::vector<int>{10, 0, 1, 20, 22}));
+    for (int k : test::keys_of(b))
+        CHECK(std::as_const(b).read(k).v == k);
+}
+
+// a batch on shared data clones it once
+template <typename Traits>
+void one_clone_per_batch() {
+    using B = binder<int, fragile, Traits>;
+    auto a = make<B>(100);
+    notes batch;
+    for (int i = 0; i < 50; ++i)
+        batch.emplace_back(1000 + i, 1000 + i);
+
+    auto b = a;
+    auto before = write_clones();
+    b.insert_after_range(10, batch.begin(), batch.end());
+    CHECK(write_clones() - before == 1);
+    CHECK(a.size() == 100 && b.size() == 150);
+
+    auto c = b;
+    before = write_clones();
+    c.remove_keys(std::vector<int>{1000, 1001, 5, 6});
+    CHECK(write_clones() - before == 1);
+    CHECK(b.size() == 150 && c.size() == 146);
+}
+
+// checks that b still holds exactly the notes 0..n-1 in order
+template <typename B>
+void check_intact(B const& b, int n) {
+    CHECK(b.size() == static_cast<std::size_t>(n));
+    int i = 0;
+    for (auto it = b.cbegin(); it != b.cend(); ++it, ++i)
+        CHECK(it.key() == i && it->v == i);
+    CHECK(b.contains(n - 1) && !b.contains(1000));
+}
+
+// a failing batch leaves the binder as it was, shared or not
+template <typename Traits>
+void failed_batches_change_nothing() {
+    using B = binder<int, fragile, Traits>;
+    notes repeated{{1000, 0}, {1001, 1}, {1000, 2}};
+    notes present{{1000, 0}, {1001, 1}, {50, 2}};
+    notes fine{{1000, 0}, {1001, 1}, {1002, 2}, {1003, 3}};
+
+    for (bool shared : {false, true}) {
+        auto b = make<B>(100);
+        B copy;
+        if (shared)
+            copy = b;
+        CHECK_THROWS(b.insert_front_range(repeated.begin(), repeated.end()), std::invalid_argument);
+        check_intact(b, 100);
+        CHECK_THROWS(b.insert_after_range(99, present.begin(), present.end()), std::invalid_argument);
+        check_intact(b, 100);
+        CHECK_THROWS(b.insert_after_range(1000, fine.begin(), fine.end()), std::invalid_argument);
+        check_intact(b, 100);
+        CHECK_THROWS(b.remove_keys(std::vector<int>{1, 2, 1000}), std::invalid_argument);
+        check_intact(b, 100);
+
+        // the third copy into the binder throws
+        fragile::budget = 2;
+        CHECK_THROWS(b.insert_after_range(50, fine.begin(), fine.end()), std::runtime_error);
+        fragile::budget = -1;
+        check_intact(b, 100);
+        if (shared)
+            check_intact(copy, 100);
+    }
+}
+
+// references handed out by read() before a failed batch still refer to the binder's values
+template <typename Traits>
+void failed_batch_keeps_references() {
+    using B = binder<int, fragile, Traits>;
+    auto b = make<B>(10);
+    fragile& r = b.read(3);
+    notes present{{1000, 0}, {1001, 1}, {5, 2}};
+    CHECK_THROWS(b.insert_front_range(present.begin(), present.end()), std::invalid_argument);
+    r.v = 33;
+    CHECK(std::as_const(b).read(3).v == 33);
+    auto copy = b;
+    r.v = 34;
+    CHECK(std::as_const(copy).read(3).v == 33);
+}
+
+// value whose failing copy makes every later allocation of the resource fail too
+struct poisoning {
+    static inline long budget = -1;
+    static inline test::counting_resource* resource = nullptr;
+
+    int v;
+
+    poisoning(int x) : v{x} {}
+
+    poisoning(poisoning const& rhs) : v{rhs.v} {
+        if (budget == 0) {
+            resource->budget = 0;
+            throw std::runtime_error("copy failed");
+        }
+        if (budget > 0)
+            --budget;
+    }
+
+    poisoning& operator=(poisoning const&) = default;
+};
+
+// undoing a failed batch allocates nothing, also while a lazy index isn't built
+template <typename Traits>
+void rollback_doesnt_allocate() {
+    using B = binder<int, poisoning, Traits>;
+    test::counting_resource res;
+    poisoning::resource = &res;
+    std::vector<std::pair<int, poisoning>> batch;
+    for (int i = 0; i < 10; ++i)
+        batch.emplace_back(1000 + i, i);
+
+    B b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    for (int i = 99; i >= 0; --i)
+        b.insert_front(i, i);
+    for (long budget : {2, 5, 9}) {
+        poisoning::budget = budget;
+        CHECK_THROWS(b.insert_front_range(batch.begin(), batch.end()), std::runtime_error);
+        res.budget = -1;
+        poisoning::budget = budget;
+        CHECK_THROWS(b.insert_after_range(50, batch.begin(), batch.end()), std::runtime_error);
+        poisoning::budget = -1;
+        res.budget = -1;
+        CHECK(b.size() == 100 && !b.contains(1000) && !b.contains(1001));
+        int i = 0;
+        for (auto it = b.cbegin(); it != b.cend(); ++it, ++i)
+            CHECK(it.key() == i && it->v == i);
+    }
+    b.insert_after_range(50, batch.begin(), batch.end());
+    CHECK(b.size() == 110 && std::as_const(b).read(1009).v == 9);
+}
+
+} // namespace
+
+int main() {
+    inserts_and_removes_in_order<default_binder_traits>();
+    inserts_and_removes_in_order<test::slab_hash_traits>();
+    inserts_and_removes_in_order<test::persistent_traits>();
+    one_clone_per_batch<default_binder_traits>();
+    one_clone_per_batch<test::hash_traits>();
+    one_clone_per_batch<test::persistent_traits>();
+    failed_batches_change_nothing<default_binder_traits>();
+    failed_batches_change_nothing<test::hash_traits>();
+    failed_batches_change_nothing<test::slab_hash_traits>();
+    failed_batches_change_nothing<test::persistent_traits>();
+    failed_batch_keeps_references<default_binder_traits>();
+    failed_batch_keeps_references<test::persistent_traits>();
+    rollback_doesnt_allocate<test::lazy_pmr_traits>();
+    rollback_doesnt_allocate<lazy_hash_pmr_traits>();
+}
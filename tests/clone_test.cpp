@@ -0,0 +1,147 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// counts its copies, and throws on the copy after the budget runs out
+struct counted {
+    static inline long copies = 0;
+    static inline long budget = -1;
+
+    int v;
+
+    explicit counted(int x) : v{x} {}
+
+    counted(counted const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+        ++copies;
+    }
+
+    counted& operator=(counted const&) = default;
+};
+
+struct colliding_hash {
+    std::size_t operator()(int) const noexcept {
+        return 7;
+    }
+};
+
+// slab copies keep the handles of the original, so the hash table is copied slot by slot
+struct colliding_traits : test::slab_traits {
+    using index = custom_hash_index<colliding_hash, std::equal_to<int>>;
+};
+
+template <typename Traits>
+binder<int, counted, Traits> make(int n) {
+    binder<int, counted, Traits> b;
+    for (int i = n - 1; i >= 0; --i)
+        b.insert_front(i, counted{i});
+    return b;
+}
+
+// a deep copy copies every value once, the index is rebuilt from the copied notes
+template <typename Traits>
+void clones_copy_each_value_once() {
+    auto a = make<Traits>(100);
+    a.read(0);
+    counted::copies = 0;
+    auto b = a;
+    CHECK(counted::copies == 100);
+    CHECK(test::keys_of(a) == test::keys_of(b));
+    for (int i = 0; i < 100; ++i)
+        CHECK(std::as_const(b).read(i).v == i);
+    b.remove(50);
+    b.insert_after(10, 500, counted{500});
+    CHECK(a.contains(50) && !a.contains(500));
+    CHECK(std::next(b.find(10)).key() == 500);
+}
+
+// a copy that throws half-way leaves the original intact and releases what it made
+template <typename Traits>
+void failed_clone_leaves_original() {
+    auto a = make<Traits>(100);
+    for (long budget = 0; budget < 100; budget += 7) {
+        counted::budget = budget;
+        CHECK_THROWS([&] {
+            auto b = a;
+            b.remove(3);
+        }(), std::runtime_error);
+        counted::budget = -1;
+    }
+    CHECK(a.size() == 100);
+    for (int i = 0; i < 100; ++i)
+        CHECK(std::as_const(a).read(i).v == i);
+}
+
+// erased slots are copied too: probes of keys inserted after the erased key run through them
+void clone_keeps_erased_slots() {
+    binder<int, int, colliding_traits> a;
+    for (int i = 0; i < 8; ++i)
+        a.insert_front(i, i);
+    a.remove(0);
+    a.remove(3);
+    auto b = a;
+    b.insert_front(100, 100);
+    for (int i : {1, 2, 4, 5, 6, 7}) {
+        CHECK(b.contains(i));
+        CHECK(std::as_const(b).read(i) == i);
+    }
+    CHECK(!b.contains(0) && !b.contains(3));
+    CHECK_THROWS(b.insert_front(7, 7), std::invalid_argument);
+    CHECK(b.size() == 7);
+}
+
+// key that counts its comparisons
+struct compared {
+    static inline long comparisons = 0;
+
+    int k;
+
+    friend bool operator<(compared const& a, compared const& b) {
+        ++comparisons;
+        return a.k < b.k;
+    }
+};
+
+// an ordered index is copied in key order with the handles of the copy, without sorting
+template <typename Traits>
+void ordered_clone_doesnt_sort() {
+    int const n = 10000;
+    binder<compared, int, Traits> a;
+    for (int i = 0; i < n; ++i)
+        a.insert_front(compared{i * 7919 % n}, i);
+    a.read(compared{0});
+    compared::comparisons = 0;
+    auto b = a;
+    b.remove(compared{0});
+    CHECK(compared::comparisons < 3 * n);
+    for (int i = 1; i < n; i += 13)
+        CHECK(std::as_const(b).read(compared{i * 7919 % n}) == i);
+    CHECK(!b.contains(compared{0}) && a.contains(compared{0}) && b.size() == n - 1u);
+    b.insert_front(compared{n}, n);
+    CHECK(std::as_const(b).read(compared{n}) == n && b.cbegin().key().k == n);
+}
+
+} // namespace
+
+int main() {
+    clones_copy_each_value_once<default_binder_traits>();
+    clones_copy_each_value_once<test::hash_traits>();
+    clones_copy_each_value_once<test::slab_traits>();
+    clones_copy_each_value_once<test::slab_hash_traits>();
+    clones_copy_each_value_once<test::ranked_traits>();
+    failed_clone_leaves_original<default_binder_traits>();
+    failed_clone_leaves_original<test::slab_hash_traits>();
+    clone_keeps_erased_slots();
+    ordered_clone_doesnt_sort<default_binder_traits>();
+    ordered_clone_doesnt_sort<test::ranked_traits>();
+}
@@ -0,0 +1,114 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <type_traits>
+
+#include "concurrent_binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+template <typename Traits>
+void behaves_like_a_binder() {
+    concurrent_binder<int, std::string, Traits> c;
+    c.insert_front(1, "a");
+    c.insert_after(1, 2, "b");
+    CHECK(c.try_insert_front(1, "x") == insert_status::key_exists);
+    CHECK(c.try_insert_after(9, 3, "x") == insert_status::previous_missing);
+    CHECK(c.size() == 2 && c.read(2) == "b");
+    CHECK_THROWS(c.read(9), std::invalid_argument);
+    CHECK_THROWS(c.remove(9), std::invalid_argument);
+    CHECK(c.size() == 2);
+
+    c.remove(2);
+    c.remove();
+    CHECK(c.size() == 0);
+}
+
+// update hands out a value, references into a private version can't escape
+template <typename Traits>
+void update_returns_by_value() {
+    concurrent_binder<int, std::string, Traits> c;
+    c.insert_front(1, "a");
+    auto s = c.update([](auto& b) -> std::string& { return b.read(1); });
+    static_assert(std::is_same_v<decltype(s), std::string>);
+    CHECK(s == "a");
+
+    c.update([](auto& b) { b.insert_front(2, "b"); });
+    CHECK(c.size() == 2);
+
+    // a failing update publishes nothing
+    CHECK_THROWS(c.update([](auto& b) {
+        b.insert_front(3, "c");
+        b.remove(9);
+    }), std::invalid_argument);
+    CHECK(c.size() == 2);
+}
+
+// a snapshot keeps the version it was taken from
+template <typename Traits>
+void snapshots_are_stable() {
+    concurrent_binder<int, std::string, Traits> c;
+    c.insert_front(1, "a");
+    auto old = c.snapshot();
+    c.insert_front(2, "b");
+    c.update([](auto& b) { b.read(1) = "x"; });
+    CHECK(old->size() == 1 && std::as_const(*old).read(1) == "a");
+    c.clear();
+    CHECK(c.size() == 0 && old->size() == 1);
+}
+
+// readers iterating snapshots always see consistent versions while writers run
+template <typename Traits>
+void readers_and_writers() {
+    concurrent_binder<int, long, Traits> c;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> consistent{true};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+        readers.emplace_back([&] {
+            while (!stop) {
+                auto s = c.snapshot();
+                long sum = 0;
+                std::size_t n = 0;
+                for (auto it = s->cbegin(); it != s->cend(); ++it, ++n)
+                    sum += *it;
+                if (n != s->size() || sum != static_cast<long>(n))
+                    consistent = false;
+            }
+        });
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w)
+        writers.emplace_back([&c, w] {
+            for (int i = 0; i < 500; ++i) {
+                c.insert_front(w * 100000 + i, 1);
+                if (i % 3 == 0)
+                    c.remove(w * 100000 + i);
+            }
+        });
+    for (auto& t : writers)
+        t.join();
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+    CHECK(consistent);
+    CHECK(c.size() == 2 * (500 - 167));
+}
+
+} // namespace
+
+int main() {
+    behaves_like_a_binder<default_binder_traits>();
+    behaves_like_a_binder<test::persistent_traits>();
+    behaves_like_a_binder<test::compact_traits>();
+    update_returns_by_value<default_binder_traits>();
+    update_returns_by_value<test::persistent_traits>();
+    snapshots_are_stable<default_binder_traits>();
+    snapshots_are_stable<test::persistent_traits>();
+    snapshots_are_stable<test::compact_traits>();
+    readers_and_writers<default_binder_traits>();
+    readers_and_writers<test::persistent_traits>();
+}
@@ -0,0 +1,116 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// the configurations the benchmarks in bench/ compare
+
+struct hash_slab_traits : default_binder_traits {
+    using index = hash_index;
+    using storage = slab_storage;
+};
+
+template <typename K>
+K make_key(int i);
+
+template <>
+int make_key<int>(int i) {
+    return i;
+}
+
+template <>
+std::string make_key<std::string>(int i) {
+    return "binder-benchmark-key-" + std::to_string(i);
+}
+
+template <typename K, typename Traits>
+binder<K, int, Traits> make_binder(int n) {
+    binder<K, int, Traits> b;
+    for (int i = 0; i < n; ++i)
+        b.insert_front(make_key<K>(i), i);
+    return b;
+}
+
+struct clones {
+    std::uint64_t copy;
+    std::uint64_t write;
+};
+
+clones clones_now() {
+    return {global_clone_counters.on_copy.load(), global_clone_counters.on_write.load()};
+}
+
+// the copy is cheap, the first modification of either binder clones the notes once
+template <typename K, typename Traits>
+void copy_then_mutate() {
+    auto const b = make_binder<K, Traits>(100);
+    auto before = clones_now();
+    for (int round = 0; round < 10; ++round) {
+        auto c = b;
+        c.insert_front(make_key<K>(100), 0);
+        c.remove(make_key<K>(0));
+        CHECK(c.size() == 100 && b.contains(make_key<K>(0)));
+    }
+    auto after = clones_now();
+    CHECK(after.copy == before.copy && after.write == before.write + 10);
+}
+
+// a binder that handed out a reference by non-const read() clones on every copy
+template <typename K, typename Traits>
+void copy_after_read() {
+    auto b = make_binder<K, Traits>(100);
+    auto before = clones_now();
+    for (int round = 0; round < 10; ++round) {
+        b.read(make_key<K>(0)) = round;
+        auto c = b;
+        CHECK(std::as_const(c).read(make_key<K>(0)) == round);
+    }
+    auto after = clones_now();
+    CHECK(after.copy == before.copy + 10 && after.write == before.write);
+}
+
+// moves and const reads never clone
+template <typename K, typename Traits>
+void moves_and_reads() {
+    auto b = make_binder<K, Traits>(100);
+    auto shared = b;
+    decltype(b) c;
+    auto before = clones_now();
+    for (int round = 0; round < 10; ++round) {
+        c = std::move(b);
+        b = std::move(c);
+        CHECK(std::as_const(b).read(make_key<K>(round)) == round);
+        long sum = 0;
+        for (auto it = b.cbegin(); it != b.cend(); ++it)
+            sum += *it;
+        CHECK(sum == 99 * 100 / 2);
+    }
+    auto after = clones_now();
+    CHECK(after.copy == before.copy && after.write == before.write);
+    CHECK(b.is_shared() && shared.is_shared());
+}
+
+template <typename K, typename Traits>
+void run() {
+    copy_then_mutate<K, Traits>();
+    copy_after_read<K, Traits>();
+    moves_and_reads<K, Traits>();
+}
+
+} // namespace
+
+int main() {
+    run<int, default_binder_traits>();
+    run<int, hash_slab_traits>();
+    run<int, test::persistent_traits>();
+    run<std::string, default_binder_traits>();
+    run<std::string, hash_slab_traits>();
+    run<std::string, test::persistent_traits>();
+}
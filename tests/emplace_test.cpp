@@ -0,0 +1,131 @@
+#include <string>
+#include <vector>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// counts copies and moves of itself
+struct tracked {
+    static inline int copies = 0;
+    static inline int moves = 0;
+
+    int v;
+
+    explicit tracked(int x) : v{x} {}
+
+    tracked(tracked const& rhs) : v{rhs.v} {
+        ++copies;
+    }
+
+    tracked(tracked&& rhs) noexcept : v{rhs.v} {
+        ++moves;
+    }
+
+    tracked& operator=(tracked const&) = default;
+
+    friend bool operator<(tracked const& a, tracked const& b) noexcept {
+        return a.v < b.v;
+    }
+
+    friend bool operator==(tracked const& a, tracked const& b) noexcept {
+        return a.v == b.v;
+    }
+
+    static void reset() {
+        copies = 0;
+        moves = 0;
+    }
+};
+
+struct tracked_hash {
+    std::size_t operator()(tracked const& t) const noexcept {
+        return std::hash<int>{}(t.v);
+    }
+};
+
+struct hash_traits : default_binder_traits {
+    using index = custom_hash_index<tracked_hash, std::equal_to<tracked>>;
+};
+
+// the index refers to the key in the note, so an insertion copies the key once
+template <typename Traits>
+void keys_are_stored_once() {
+    binder<tracked, int, Traits> b;
+    tracked k{1};
+    tracked::reset();
+    b.insert_front(k, 1);
+    CHECK(tracked::copies == 1);
+
+    tracked::reset();
+    b.insert_front(tracked{2}, 2);
+    CHECK(tracked::copies == 0);
+
+    tracked::reset();
+    b.insert_after(tracked{2}, tracked{3}, 3);
+    CHECK(tracked::copies == 0);
+    CHECK((test::values_of(b) == std::vector<int>{2, 3, 1}));
+}
+
+template <typename Traits>
+void rvalues_are_moved() {
+    binder<int, tracked, Traits> b;
+    tracked::reset();
+    b.insert_front(1, tracked{1});
+    b.insert_after(1, 2, tracked{2});
+    CHECK(tracked::copies == 0);
+
+    tracked::reset();
+    b.emplace_front(3, 3);
+    b.emplace_after(3, 4, 4);
+    CHECK(tracked::copies == 0 && tracked::moves == 0);
+    CHECK((test::keys_of(b) == std::vector<int>{3, 4, 1, 2}));
+    CHECK(std::as_const(b).read(4).v == 4);
+}
+
+// emplace passes its arguments to the value's constructor
+template <typename Traits>
+void constructs_from_arguments() {
+    binder<std::string, std::vector<int>, Traits> b;
+    b.emplace_front("a", 3u, 7);
+    b.emplace_after("a", "b", std::initializer_list<int>{1, 2});
+    b.emplace_front(std::string{"c"});
+    CHECK((std::as_const(b).read("a") == std::vector<int>{7, 7, 7}));
+    CHECK((std::as_const(b).read("b") == std::vector<int>{1, 2}));
+    CHECK(std::as_const(b).read("c").empty());
+    CHECK_THROWS(b.emplace_front("a", 1u, 1), std::invalid_argument);
+    CHECK_THROWS(b.emplace_after("x", "d", 1u, 1), std::invalid_argument);
+    CHECK(b.size() == 3);
+}
+
+// a rejected insertion leaves its arguments as they were
+template <typename Traits>
+void rejected_arguments_are_untouched() {
+    binder<std::string, std::string, Traits> b;
+    b.insert_front("a", "1");
+    std::string k = "a";
+    std::string v = "value";
+    CHECK_THROWS(b.insert_front(std::move(k), std::move(v)), std::invalid_argument);
+    CHECK(k == "a" && v == "value");
+    std::string k2 = "b";
+    CHECK_THROWS(b.insert_after("missing", std::move(k2), std::move(v)), std::invalid_argument);
+    CHECK(k2 == "b" && v == "value");
+}
+
+} // namespace
+
+int main() {
+    keys_are_stored_once<default_binder_traits>();
+    keys_are_stored_once<hash_traits>();
+    rvalues_are_moved<default_binder_traits>();
+    rvalues_are_moved<test::slab_traits>();
+    constructs_from_arguments<default_binder_traits>();
+    constructs_from_arguments<test::slab_traits>();
+    constructs_from_arguments<test::persistent_traits>();
+    rejected_arguments_are_untouched<default_binder_traits>();
+    rejected_arguments_are_untouched<test::slab_traits>();
+    rejected_arguments_are_untouched<test::persistent_traits>();
+}
@@ -0,0 +1,84 @@
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct string_hash_slab_traits : default_binder_traits {
+    using index = custom_hash_index<string_hash>;
+    using storage = slab_storage;
+};
+
+struct small_traits : default_binder_traits {
+    using index = small_index<8>;
+    using storage = inline_slab_storage<4>;
+};
+
+template <typename Traits>
+void finds_notes() {
+    using B = binder<std::string, int, Traits>;
+    B b;
+    CHECK(b.find("x") == b.cend() && b.read_if("x") == nullptr && std::as_const(b).read_if("x") == nullptr);
+    CHECK(!b.contains("x"));
+    for (int i = 0; i < 50; ++i)
+        b.insert_front("k" + std::to_string(i), i);
+
+    auto it = b.find("k7");
+    CHECK(it != b.cend() && *it == 7 && it.key() == "k7");
+    ++it;
+    CHECK(*it == 6);
+    CHECK(b.find(std::string{"zz"}) == b.cend());
+    CHECK(*std::as_const(b).read_if("k3") == 3 && std::as_const(b).read_if("zz") == nullptr);
+    CHECK(b.contains("k49") && !b.contains("k50"));
+}
+
+// misses don't clone and don't make the binder unshareable, hits do like read()
+template <typename Traits>
+void misses_keep_sharing() {
+    using B = binder<std::string, int, Traits>;
+    B b;
+    for (int i = 0; i < 50; ++i)
+        b.insert_front("k" + std::to_string(i), i);
+    B c = b;
+    CHECK(c.read_if("missing") == nullptr);
+    CHECK(b.stats().use_count == 2);
+    B d = c;
+    CHECK(d.stats().deep_copies == 0 && b.stats().use_count == 3);
+
+    int* p = c.read_if("k5");
+    CHECK(p != nullptr && *p == 5);
+    *p = 55;
+    CHECK(std::as_const(b).read("k5") == 5 && std::as_const(d).read("k5") == 5);
+    CHECK(std::as_const(c).read("k5") == 55);
+
+    // the pointer may still be in use, so the next copy is deep
+    B e = c;
+    *p = 56;
+    CHECK(std::as_const(e).read("k5") == 55);
+}
+
+void finds_packed_keys() {
+    binder<int, int, small_traits> s;
+    for (int i = 0; i < 20; ++i) {
+        s.insert_front(i, i);
+        CHECK(s.find(i) != s.cend() && *s.read_if(i) == i);
+    }
+    CHECK(s.find(99) == s.cend() && s.read_if(99) == nullptr);
+}
+
+} // namespace
+
+int main() {
+    finds_notes<default_binder_traits>();
+    finds_notes<string_hash_slab_traits>();
+    finds_notes<test::persistent_traits>();
+    misses_keep_sharing<default_binder_traits>();
+    misses_keep_sharing<string_hash_slab_traits>();
+    misses_keep_sharing<test::persistent_traits>();
+    finds_packed_keys();
+}
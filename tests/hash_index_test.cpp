@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// every key lands in the same probe sequence
+struct colliding_hash {
+    std::size_t operator()(int) const noexcept {
+        return 42;
+    }
+};
+
+struct colliding_traits : default_binder_traits {
+    using index = custom_hash_index<colliding_hash, std::equal_to<int>>;
+};
+
+template <typename Traits>
+void insert_read_remove() {
+    binder<int, std::string, Traits> b;
+    b.insert_front(1, "a");
+    b.insert_front(2, "b");
+    b.insert_after(2, 3, "c");
+    CHECK((test::keys_of(b) == std::vector<int>{2, 3, 1}));
+    CHECK(std::as_const(b).read(3) == "c");
+    CHECK(b.contains(1) && !b.contains(4));
+    CHECK_THROWS(b.insert_front(1, "x"), std::invalid_argument);
+    CHECK_THROWS(b.insert_after(4, 5, "x"), std::invalid_argument);
+    CHECK_THROWS(std::as_const(b).read(4), std::invalid_argument);
+
+    b.remove(3);
+    CHECK((test::keys_of(b) == std::vector<int>{2, 1}));
+    b.remove();
+    CHECK((test::keys_of(b) == std::vector<int>{1}));
+    CHECK_THROWS(b.remove(2), std::invalid_argument);
+}
+
+// random insertions and removals against a vector of the expected notes, with enough
+// removals that lookups probe through many erased slots
+template <typename Traits>
+void matches_model(int key_range) {
+    binder<int, int, Traits> b;
+    std::vector<int> model;
+    std::mt19937 gen{7};
+    for (int i = 0; i < 20000; ++i) {
+        int k = static_cast<int>(gen() % static_cast<unsigned>(key_range));
+        auto pos = std::ranges::find(model, k);
+        switch (gen() % 3) {
+        case 0:
+            if (pos == model.end()) {
+                b.insert_front(k, -k);
+                model.insert(model.begin(), k);
+            }
+            break;
+        case 1:
+            if (pos == model.end() && !model.empty()) {
+                int prev = model[gen() % model.size()];
+                b.insert_after(prev, k, -k);
+                model.insert(std::ranges::find(model, prev) + 1, k);
+            }
+            break;
+        default:
+            if (pos != model.end()) {
+                b.remove(k);
+                model.erase(pos);
+            }
+            break;
+        }
+        CHECK(b.contains(k) == (std::ranges::find(model, k) != model.end()));
+    }
+    CHECK(test::keys_of(b) == model);
+    for (int k : model)
+        CHECK(std::as_const(b).read(k) == -k);
+}
+
+void copies_share_until_modified() {
+    binder<std::string, int, test::hash_traits> a;
+    for (int i = 0; i < 100; ++i)
+        a.insert_front(std::to_string(i), i);
+    auto b = a;
+    CHECK(a.is_shared() && b.is_shared());
+    b.remove("50");
+    b.insert_front("new", -1);
+    CHECK(a.size() == 100 && a.contains("50") && !a.contains("new"));
+    CHECK(b.size() == 100 && !b.contains("50") && b.contains("new"));
+    for (int i = 0; i < 100; ++i)
+        CHECK(std::as_const(a).read(std::to_string(i)) == i);
+}
+
+} // namespace
+
+int main() {
+    insert_read_remove<test::hash_traits>();
+    insert_read_remove<colliding_traits>();
+    matches_model<test::hash_traits>(500);
+    matches_model<colliding_traits>(64);
+    copies_share_until_modified();
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+std::atomic<long> allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n != 0 ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct string_hash_traits : default_binder_traits {
+    using index = custom_hash_index<string_hash>;
+};
+
+struct string_hash_slab_traits : string_hash_traits {
+    using storage = slab_storage;
+};
+
+static_assert(binder<std::string, int>::is_lookup_key<std::string_view>);
+static_assert(binder<std::string, int, string_hash_traits>::is_lookup_key<std::string_view>);
+static_assert(binder<std::string, int, string_hash_traits>::is_lookup_key<char const*>);
+static_assert(!binder<std::string, int, test::hash_traits>::is_lookup_key<std::string_view>);
+
+// lookups by std::string_view and char const* don't build a temporary std::string
+template <typename Traits>
+void looks_up_without_keys() {
+    using B = binder<std::string, int, Traits>;
+    B b;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back("a-rather-long-key-number-" + std::to_string(i));
+        b.insert_front(keys.back(), i);
+    }
+    std::string_view sv = keys[42];
+    B const& cb = b;
+
+    auto before = allocations.load();
+    CHECK(cb.read(sv) == 42 && b.contains(sv) && !b.contains(std::string_view{"a-rather-long-missing-key"}));
+    CHECK(cb.read(keys[7].c_str()) == 7);
+    CHECK(allocations.load() == before);
+    CHECK_THROWS(cb.read(std::string_view{"nope"}), std::invalid_argument);
+
+    // mutable reads and removals work alike, on shared data as well
+    b.read(sv) = 1000;
+    CHECK(cb.read(keys[42]) == 1000);
+    B c = b;
+    c.remove(sv);
+    CHECK(!c.contains(keys[42]) && b.contains(keys[42]) && c.size() == 99);
+    B d = c;
+    d.remove(std::string_view{keys[3]});
+    CHECK(c.contains(keys[3]) && !d.contains(keys[3]));
+    CHECK_THROWS(d.remove(std::string_view{"nope"}), std::invalid_argument);
+    CHECK(!B{}.contains(sv));
+}
+
+// other indexes still accept anything convertible to the key
+void converts_otherwise() {
+    binder<std::string, int, test::hash_traits> h;
+    h.insert_front("k", 1);
+    CHECK(std::as_const(h).read("k") == 1 && h.contains("k"));
+
+    binder<int, int> o;
+    o.insert_front(1, 2);
+    CHECK(std::as_const(o).read(1L) == 2 && o.contains(1L));
+
+    small_binder<int, int, 4> s;
+    s.insert_front(1, 2);
+    CHECK(std::as_const(s).read(1L) == 2 && s.contains(1L));
+}
+
+} // namespace
+
+int main() {
+    looks_up_without_keys<default_binder_traits>();
+    looks_up_without_keys<string_hash_traits>();
+    looks_up_without_keys<string_hash_slab_traits>();
+    looks_up_without_keys<test::persistent_traits>();
+    converts_otherwise();
+}
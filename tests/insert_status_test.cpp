@@ -0,0 +1,81 @@
+#include <string>
+#include <vector>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// std::hash<int> that counts its calls
+struct counting_hash {
+    static inline long calls = 0;
+
+    std::size_t operator()(int k) const noexcept {
+        ++calls;
+        return std::hash<int>{}(k);
+    }
+};
+
+struct counting_traits : default_binder_traits {
+    using index = custom_hash_index<counting_hash, std::equal_to<int>>;
+    using storage = slab_storage;
+};
+
+template <typename Traits>
+void reports_status() {
+    binder<int, std::string, Traits> b;
+    CHECK(b.try_insert_after(1, 2, "x") == insert_status::previous_missing);
+    CHECK(b.try_insert_front(1, "a") == insert_status::inserted);
+    CHECK(b.try_insert_front(1, "b") == insert_status::key_exists);
+    CHECK(b.try_insert_after(1, 1, "b") == insert_status::key_exists);
+    CHECK(b.try_insert_after(7, 2, "b") == insert_status::previous_missing);
+    CHECK(b.try_insert_after(1, 2, "b") == insert_status::inserted);
+    CHECK((test::keys_of(b) == std::vector<int>{1, 2}));
+    CHECK(std::as_const(b).read(1) == "a");
+}
+
+// a rejected insertion into a shared binder doesn't clone it
+template <typename Traits>
+void rejection_keeps_sharing() {
+    binder<int, std::string, Traits> a;
+    a.insert_front(1, "a");
+    auto b = a;
+    CHECK(b.try_insert_front(1, "b") == insert_status::key_exists);
+    CHECK(b.try_insert_after(5, 2, "b") == insert_status::previous_missing);
+    CHECK(a.is_shared() && b.is_shared());
+    CHECK(b.try_insert_after(1, 2, "b") == insert_status::inserted);
+    CHECK(!a.is_shared() && a.size() == 1 && b.size() == 2);
+}
+
+// an insertion into unshared data hashes the new key once, whether or not it's present,
+// unless the table grows
+void single_lookup() {
+    binder<int, int, counting_traits> b;
+    b.insert_front(0, 0);
+    for (int i = 1; i < 1000; ++i) {
+        auto bytes = b.stats().index_bytes;
+        auto before = counting_hash::calls;
+        b.insert_front(i, i);
+        if (b.stats().index_bytes == bytes)
+            CHECK(counting_hash::calls - before == 1);
+
+        before = counting_hash::calls;
+        CHECK(b.try_insert_front(i, i) == insert_status::key_exists);
+        CHECK(counting_hash::calls - before == 1);
+    }
+    CHECK(b.size() == 1000);
+}
+
+} // namespace
+
+int main() {
+    reports_status<default_binder_traits>();
+    reports_status<test::hash_traits>();
+    reports_status<test::persistent_traits>();
+    rejection_keeps_sharing<default_binder_traits>();
+    rejection_keeps_sharing<test::hash_traits>();
+    rejection_keeps_sharing<test::persistent_traits>();
+    single_lookup();
+}
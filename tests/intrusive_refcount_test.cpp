@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct compact_slab_traits : compact_binder_traits {
+    using index = hash_index;
+    using storage = slab_storage;
+};
+
+struct compact_persistent_traits : compact_binder_traits {
+    using storage = persistent_storage;
+};
+
+struct compact_pmr_traits : compact_binder_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+static_assert(intrusive_refcount::thread_safe);
+static_assert(sizeof(compact_binder<int, std::string>) == sizeof(void*));
+static_assert(sizeof(binder<int, std::string, compact_slab_traits>) == sizeof(void*));
+
+template <typename Traits>
+void copies_share_until_written() {
+    using B = binder<int, std::string, Traits>;
+    B a{{1, "a"}, {2, "b"}};
+    auto b = a;
+    auto c = b;
+    CHECK(a.stats().use_count == 3 && a.is_shared());
+
+    c.insert_front(3, "c");
+    CHECK(a.stats().use_count == 2 && c.stats().use_count == 1);
+    CHECK(a.size() == 2 && c.size() == 3);
+
+    B moved = std::move(b);
+    CHECK(b.size() == 0 && moved.size() == 2 && a.stats().use_count == 2);
+    moved = B{};
+    CHECK(!a.is_shared());
+
+    // a reference from read() makes the next copy deep
+    std::string& r = a.read(1);
+    B d = a;
+    r = "x";
+    CHECK(std::as_const(d).read(1) == "a" && !a.is_shared());
+}
+
+// copies taken and modified from many threads leave the shared original alone
+template <typename Traits>
+void concurrent_copies() {
+    using B = binder<int, long, Traits>;
+    B base;
+    for (int i = 0; i < 1000; ++i)
+        base.insert_front(i, i);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&base, t] {
+            for (int r = 0; r < 100; ++r) {
+                B c = base;
+                c.read(t) = -1;
+                c.remove(500 + t);
+                CHECK(std::as_const(c).read(t) == -1 && c.size() == 999);
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    CHECK(std::as_const(base).read(3) == 3 && base.size() == 1000);
+}
+
+// the data, count included, goes back to the allocator with its last owner
+void releases_with_last_owner() {
+    test::counting_resource res;
+    {
+        binder<int, int, compact_pmr_traits> a{std::pmr::polymorphic_allocator<std::byte>{&res}};
+        a.insert_front(1, 1);
+        binder<int, int, compact_pmr_traits> b{a, a.get_allocator()};
+        a.clear();
+        CHECK(res.in_use > 0 && b.size() == 1);
+    }
+    CHECK(res.in_use == 0);
+}
+
+} // namespace
+
+int main() {
+    copies_share_until_written<compact_binder_traits>();
+    copies_share_until_written<compact_slab_traits>();
+    copies_share_until_written<compact_persistent_traits>();
+    concurrent_copies<compact_binder_traits>();
+    concurrent_copies<compact_slab_traits>();
+    releases_with_last_owner();
+}
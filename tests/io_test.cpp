@@ -0,0 +1,161 @@
+#include <string>
+#include <vector>
+#include <span>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "binder_io.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct point {
+    double x;
+    double y;
+};
+
+// key without an order, served by a custom hash index
+struct tag {
+    std::uint32_t id;
+
+    bool operator==(tag const&) const = default;
+};
+
+struct tag_hash {
+    std::size_t operator()(tag t) const noexcept {
+        return t.id;
+    }
+};
+
+// trivially copyable value without a default constructor
+struct reading {
+    explicit reading(double d) : v{d} {}
+
+    double v;
+};
+
+static_assert(!std::is_default_constructible_v<reading> && std::is_trivially_copyable_v<reading>);
+
+struct tag_traits : default_binder_traits {
+    using index = custom_hash_index<tag_hash, std::equal_to<tag>>;
+};
+
+template <typename Traits>
+binder<long, point, Traits> make(long n) {
+    binder<long, point, Traits> b;
+    for (long i = 0; i < n; ++i)
+        b.insert_front(i * 7919 % 10007, point{static_cast<double>(i), -static_cast<double>(i)});
+    return b;
+}
+
+template <typename B>
+std::vector<std::byte> image_of(B const& b) {
+    std::vector<std::byte> buf;
+    serialize(b, [&buf](std::span<std::byte const> s) { buf.insert(buf.end(), s.begin(), s.end()); });
+    return buf;
+}
+
+template <typename B1, typename B2>
+void check_same(B1 const& a, B2 const& b) {
+    CHECK(a.size() == b.size());
+    auto j = b.cbegin();
+    for (auto i = a.cbegin(); i != a.cend(); ++i, ++j)
+        CHECK(i.key() == j.key() && i->x == j->x && i->y == j->y);
+    CHECK(j == b.cend());
+}
+
+// an image loads into a binder of any configuration, in the same note order
+template <typename From, typename To>
+void round_trips() {
+    auto b = make<From>(10000);
+    auto buf = image_of(b);
+    check_same(b, load<binder<long, point, To>>(buf));
+
+    // a misaligned image loads as well
+    std::vector<std::byte> shifted(buf.size() + 1);
+    std::ranges::copy(buf, shifted.begin() + 1);
+    check_same(b, load<binder<long, point, To>>(std::span(shifted).subspan(1)));
+
+    std::ostringstream os;
+    serialize(b, os);
+    auto s = os.str();
+    CHECK(s.size() == buf.size() && std::memcmp(s.data(), buf.data(), buf.size()) == 0);
+
+    auto empty = image_of(binder<long, point, From>{});
+    CHECK((load<binder<long, point, To>>(empty).size() == 0));
+}
+
+// a mapped binder serves lookups and iteration from the image itself
+void maps_images() {
+    auto b = make<default_binder_traits>(10000);
+    auto buf = image_of(b);
+    mapped_binder<long, point> m{buf};
+    CHECK(m.size() == 10000 && !m.empty());
+    CHECK(m.read(7919 % 10007).x == 1 && m.contains(0) && !m.contains(-1));
+    CHECK_THROWS(m.read(-1), std::invalid_argument);
+    check_same(b, m);
+    for (auto it = b.cbegin(); it != b.cend(); ++it)
+        CHECK(m.read(it.key()).y == it->y);
+    check_same(b, m.to_binder());
+    check_same(b, m.to_binder<test::slab_hash_traits>());
+
+    mapped_binder<long, point> empty{image_of(binder<long, point>{})};
+    CHECK(empty.empty() && empty.cbegin() == empty.cend() && !empty.contains(0));
+}
+
+// images that don't match the binder or were cut short are rejected
+void rejects_bad_images() {
+    auto buf = image_of(make<default_binder_traits>(100));
+    CHECK_THROWS((load<binder<int, point>>(buf)), std::invalid_argument);
+    CHECK_THROWS((load<binder<long, double>>(buf)), std::invalid_argument);
+    CHECK_THROWS((load<binder<long, point>>(std::span(buf).first(100))), std::invalid_argument);
+    CHECK_THROWS((load<binder<long, point>>(std::span(buf).first(4))), std::invalid_argument);
+    CHECK_THROWS((mapped_binder<long, point>{std::span(buf).first(buf.size() - 1)}), std::invalid_argument);
+
+    std::vector<std::byte> shifted(buf.size() + 1);
+    std::ranges::copy(buf, shifted.begin() + 1);
+    CHECK_THROWS((mapped_binder<long, point>{std::span<std::byte const>(shifted).subspan(1)}), std::invalid_argument);
+
+    auto corrupt = buf;
+    corrupt[0] = std::byte{0};
+    CHECK_THROWS((load<binder<long, point>>(corrupt)), std::invalid_argument);
+}
+
+// keys without an order round trip as well
+void unordered_keys() {
+    binder<tag, int, tag_traits> t;
+    t.insert_front(tag{1}, 1);
+    t.insert_front(tag{2}, 2);
+    auto tags = image_of(t);
+    auto loaded = load<binder<tag, int, tag_traits>>(tags);
+    CHECK(std::as_const(loaded).read(tag{1}) == 1 && loaded.size() == 2);
+}
+
+// values are made from the bytes of the image, not assigned to
+void values_without_default() {
+    binder<long, reading> b;
+    for (long i = 0; i < 100; ++i)
+        b.insert_front(i, reading{i * 0.5});
+    auto buf = image_of(b);
+    auto loaded = load<binder<long, reading, test::slab_hash_traits>>(buf);
+    CHECK(loaded.size() == 100 && std::as_const(loaded).read(7).v == 3.5);
+    mapped_binder<long, reading> m{buf};
+    CHECK(m.read(99).v == 49.5 && m.to_binder().size() == 100);
+}
+
+} // namespace
+
+int main() {
+    round_trips<default_binder_traits, default_binder_traits>();
+    round_trips<default_binder_traits, test::slab_hash_traits>();
+    round_trips<test::slab_hash_traits, test::persistent_traits>();
+    round_trips<test::persistent_traits, default_binder_traits>();
+    maps_images();
+    rejects_bad_images();
+    unordered_keys();
+    values_without_default();
+}
@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <ranges>
+#include <iterator>
+#include <algorithm>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct small_traits : default_binder_traits {
+    using index = small_index<8>;
+    using storage = inline_slab_storage<4>;
+};
+
+template <typename Traits>
+void traverses_both_ways() {
+    using B = binder<int, int, Traits>;
+    static_assert(std::bidirectional_iterator<typename B::const_iterator>);
+    static_assert(std::ranges::bidirectional_range<B const>);
+    static_assert(std::ranges::bidirectional_range<B>);
+
+    B e;
+    CHECK(e.cbegin() == e.cend() && e.crbegin() == e.crend() && std::ranges::empty(e));
+
+    B b;
+    for (int i = 0; i < 40; ++i)
+        b.insert_front(i, i * 10);
+    b.remove(17);
+    b.insert_after(5, 100, 1000);
+
+    std::vector<int> forward;
+    std::vector<int> backward;
+    std::vector<int> keys;
+    std::vector<int> reverse_keys;
+    for (auto it = b.cbegin(); it != b.cend(); ++it) {
+        forward.push_back(*it);
+        keys.push_back(it.key());
+    }
+    for (auto r = b.crbegin(); r != b.crend(); ++r) {
+        backward.push_back(*r);
+        reverse_keys.push_back(std::prev(r.base()).key());
+    }
+    std::ranges::reverse(backward);
+    std::ranges::reverse(reverse_keys);
+    CHECK(forward == backward && keys == reverse_keys && forward.size() == 40);
+    CHECK(keys == test::keys_of(b));
+
+    std::vector<int> reversed;
+    for (int v : b | std::views::reverse)
+        reversed.push_back(v);
+    std::ranges::reverse(reversed);
+    CHECK(reversed == forward);
+}
+
+// key(), note() and stepping around a note found by key
+template <typename Traits>
+void steps_from_a_note() {
+    using B = binder<int, int, Traits>;
+    B b;
+    for (int i = 0; i < 40; ++i)
+        b.insert_front(i, i * 10);
+    b.insert_after(5, 100, 1000);
+
+    auto it = b.find(5);
+    auto n = it.note();
+    CHECK(n.first == 5 && n.second == 50);
+    --it;
+    CHECK(it.key() == 6);
+    ++it;
+    ++it;
+    CHECK(it.key() == 100 && *it == 1000);
+    CHECK(it++.key() == 100 && it.key() == 4);
+    CHECK(it--.key() == 4 && it.key() == 100);
+
+    auto last = b.cend();
+    --last;
+    CHECK(last.key() == 0 && std::ranges::distance(b.cbegin(), b.cend()) == 41);
+
+    // iterators of one binder stay valid over copies and modifications of another
+    B c = b;
+    c.remove();
+    CHECK(*c.cbegin() == 380 && it.key() == 100);
+}
+
+} // namespace
+
+int main() {
+    traverses_both_ways<default_binder_traits>();
+    traverses_both_ways<test::slab_hash_traits>();
+    traverses_both_ways<test::persistent_traits>();
+    traverses_both_ways<small_traits>();
+    steps_from_a_note<default_binder_traits>();
+    steps_from_a_note<test::slab_hash_traits>();
+    steps_from_a_note<test::persistent_traits>();
+    steps_from_a_note<small_traits>();
+}
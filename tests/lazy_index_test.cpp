@@ -0,0 +1,142 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <iterator>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct lazy_hash_slab_traits : default_binder_traits {
+    using index = lazy_index<hash_index>;
+    using storage = slab_storage;
+};
+
+struct lazy_small_traits : default_binder_traits {
+    using index = lazy_index<small_index<8>>;
+};
+
+struct lazy_hash_traits : default_binder_traits {
+    using index = lazy_index<hash_index>;
+};
+
+template <typename Traits>
+void behaves_like_an_index() {
+    using B = binder<int, int, Traits>;
+    int const n = 20000;
+    B b;
+    for (int i = 0; i < n; ++i)
+        b.insert_front(i, i * 2);
+    CHECK(b.size() == static_cast<std::size_t>(n));
+    CHECK_THROWS(b.insert_front(5, 0), std::invalid_argument);
+    CHECK_THROWS(b.insert_front(n - 1, 0), std::invalid_argument);
+    CHECK(b.size() == static_cast<std::size_t>(n));
+    CHECK(std::ranges::distance(b.cbegin(), b.cend()) == n);
+
+    // const lookups of shared data build the index from many threads at once
+    auto c = b;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&c] {
+            for (int i = 0; i < 20000; i += 7)
+                CHECK(std::as_const(c).read(i) == i * 2);
+        });
+    for (auto& t : threads)
+        t.join();
+
+    CHECK(!b.contains(-1) && b.contains(3));
+    b.remove();
+    CHECK(!b.contains(n - 1) && b.size() == static_cast<std::size_t>(n - 1));
+    b.remove(100);
+    CHECK(!b.contains(100));
+    b.insert_after(5, 100, 1);
+    CHECK(std::as_const(b).read(100) == 1);
+
+    B d;
+    for (int i = 0; i < 1000; ++i)
+        d.insert_front(i, i);
+    for (int i = 0; i < 1000; ++i)
+        d.remove();
+    CHECK(d.size() == 0);
+
+    std::vector<std::pair<int, int>> v;
+    for (int i = 0; i < 50000; ++i)
+        v.emplace_back(i * 3, i);
+    B e(from_range, v);
+    CHECK(e.size() == 50000 && std::as_const(e).read(300) == 100);
+    v.emplace_back(3, 0);
+    CHECK_THROWS(B(from_range, v), std::invalid_argument);
+
+    // a copy of an unbuilt index
+    B g;
+    for (int i = 0; i < 100; ++i)
+        g.insert_front(i, i);
+    auto h = g;
+    h.insert_front(1000, 0);
+    CHECK(std::as_const(h).read(50) == 50 && g.size() == 100 && h.size() == 101);
+
+    B x;
+    B y;
+    for (int i = 9; i >= 0; --i) {
+        x.insert_front(i, i);
+        y.insert_front(i + 10, i + 10);
+    }
+    x.merge(std::move(y));
+    CHECK(x.size() == 20 && std::as_const(x).read(15) == 15);
+    auto z = x.split_after(9);
+    CHECK(z.size() == 10 && std::as_const(z).read(15) == 15 && !x.contains(15));
+}
+
+// insert_after into an index that was never built
+template <typename Traits>
+void inserts_after_unbuilt() {
+    using B = binder<int, std::string, Traits>;
+    B b;
+    for (int i = 0; i < 100; ++i)
+        b.insert_front(i, std::to_string(i));
+    b.insert_after(50, 1000, "x");
+    CHECK(b.contains(1000) && std::as_const(b).read(1000) == "x");
+    CHECK(std::next(b.find(50)).key() == 1000);
+    b.insert_after(1000, 1001, "y");
+    CHECK(b.contains(1001) && b.size() == 102);
+
+    B c;
+    c.insert_front(1, "a");
+    c.insert_after(1, 2, "b");
+    CHECK(c.contains(2) && c.size() == 2);
+    CHECK_THROWS(c.insert_after(3, 4, "c"), std::invalid_argument);
+    CHECK_THROWS(c.insert_after(1, 2, "c"), std::invalid_argument);
+}
+
+// appending takes less index memory than an ordered index
+void saves_memory() {
+    binder<int, int, test::lazy_traits> lazy;
+    binder<int, int> ordered;
+    for (int i = 0; i < 100000; ++i) {
+        lazy.insert_front(i, i);
+        ordered.insert_front(i, i);
+    }
+    CHECK(lazy.stats().index_bytes < ordered.stats().index_bytes);
+    CHECK(std::ranges::distance(std::as_const(lazy).key_range(10, 20)) == 10);
+
+    binder<std::string, int, test::lazy_traits> s;
+    for (int i = 0; i < 1000; ++i)
+        s.insert_front(std::to_string(i), i);
+    CHECK(std::as_const(s).read("500") == 500);
+}
+
+} // namespace
+
+int main() {
+    behaves_like_an_index<test::lazy_traits>();
+    behaves_like_an_index<lazy_hash_slab_traits>();
+    behaves_like_an_index<lazy_small_traits>();
+    inserts_after_unbuilt<lazy_hash_traits>();
+    inserts_after_unbuilt<test::lazy_traits>();
+    inserts_after_unbuilt<lazy_hash_slab_traits>();
+    saves_memory();
+}
@@ -0,0 +1,88 @@
+#include <string>
+#include <vector>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct local_slab_traits : test::local_traits {
+    using index = hash_index;
+    using storage = slab_storage;
+};
+
+struct local_persistent_traits : test::local_traits {
+    using storage = persistent_storage;
+};
+
+struct local_pmr_traits : test::local_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+static_assert(!local_refcount::thread_safe);
+
+template <typename Traits>
+void copies_share_until_written() {
+    using B = binder<int, std::string, Traits>;
+    B a{{1, "a"}, {2, "b"}};
+    auto b = a;
+    auto c = b;
+    CHECK(a.stats().use_count == 3);
+    CHECK(a.is_shared());
+
+    c.insert_front(3, "c");
+    CHECK(a.stats().use_count == 2 && c.stats().use_count == 1);
+    CHECK(a.size() == 2 && c.size() == 3);
+
+    B moved = std::move(b);
+    CHECK(b.size() == 0 && moved.size() == 2);
+    CHECK(a.stats().use_count == 2);
+
+    b = moved;
+    CHECK(a.stats().use_count == 3);
+    moved.clear();
+    b.clear();
+    CHECK(a.stats().use_count == 1 && !a.is_shared());
+    a.remove(1);
+    CHECK((test::keys_of(a) == std::vector<int>{2}));
+}
+
+// a reference from read() forces the next copy to be deep
+template <typename Traits>
+void read_makes_copies_deep() {
+    using B = binder<int, std::string, Traits>;
+    B a{{1, "a"}};
+    std::string& r = a.read(1);
+    B b = a;
+    r = "changed";
+    CHECK(std::as_const(b).read(1) == "a");
+    CHECK(!a.is_shared() && !b.is_shared());
+}
+
+// the data goes back to the allocator with its last owner
+void releases_with_last_owner() {
+    test::counting_resource res;
+    binder<int, int, local_pmr_traits> a{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    a.insert_front(1, 1);
+    {
+        binder<int, int, local_pmr_traits> b{a, a.get_allocator()};
+        a.clear();
+        CHECK(res.in_use > 0 && b.size() == 1);
+    }
+    CHECK(res.in_use == 0);
+}
+
+} // namespace
+
+int main() {
+    copies_share_until_written<test::local_traits>();
+    copies_share_until_written<local_slab_traits>();
+    copies_share_until_written<local_persistent_traits>();
+    read_makes_copies_deep<test::local_traits>();
+    read_makes_copies_deep<local_slab_traits>();
+    read_makes_copies_deep<local_persistent_traits>();
+    releases_with_last_owner();
+}
@@ -0,0 +1,84 @@
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// binder with notes 0..n-1 in order, minus every third one
+template <typename B>
+B make(int n, long& sum) {
+    B b;
+    sum = 0;
+    for (int i = n - 1; i >= 0; --i) {
+        b.insert_front(i, i);
+        sum += i;
+    }
+    for (int i = 0; i < n; i += 3) {
+        b.remove(i);
+        sum -= i;
+    }
+    return b;
+}
+
+// the parts are consecutive, cover every note once and differ in length by one at most
+template <typename Traits>
+void partitions_in_order() {
+    using B = binder<int, long, Traits>;
+    long sum;
+    auto b = make<B>(1000, sum);
+    for (std::size_t parts : {1u, 3u, 7u, 100u}) {
+        auto ranges = b.partition(parts);
+        CHECK(ranges.size() == parts);
+        std::vector<long> seen;
+        for (auto& r : ranges) {
+            auto len = static_cast<std::size_t>(std::ranges::distance(r));
+            CHECK(len == b.size() / parts || len == b.size() / parts + 1);
+            for (long v : r)
+                seen.push_back(v);
+        }
+        CHECK(seen == test::values_of(b));
+    }
+    CHECK(b.partition(0).size() == 1);
+    CHECK(b.partition(5000).size() == b.size());
+    CHECK(B{}.partition(3).empty());
+}
+
+// every value is visited exactly once, whatever the number of threads
+template <typename Traits>
+void visits_every_value() {
+    using B = binder<int, long, Traits>;
+    long sum;
+    auto b = make<B>(50000, sum);
+    for (unsigned threads : {0u, 1u, 4u, 16u}) {
+        std::atomic<long> seen{0};
+        std::atomic<std::size_t> calls{0};
+        b.for_each_parallel([&](long v) {
+            seen += v;
+            ++calls;
+        }, threads);
+        CHECK(seen == sum && calls == b.size());
+    }
+    B{}.for_each_parallel([](long) { CHECK(false); });
+
+    // the first exception is passed on once all threads are done
+    CHECK_THROWS(b.for_each_parallel([](long v) {
+        if (v == 7)
+            throw std::runtime_error("failed");
+    }, 4), std::runtime_error);
+}
+
+} // namespace
+
+int main() {
+    partitions_in_order<default_binder_traits>();
+    partitions_in_order<test::slab_hash_traits>();
+    partitions_in_order<test::persistent_traits>();
+    visits_every_value<default_binder_traits>();
+    visits_every_value<test::slab_hash_traits>();
+    visits_every_value<test::persistent_traits>();
+}
@@ -0,0 +1,136 @@
+#include <new>
+#include <string>
+#include <vector>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+using persistent_binder = binder<int, std::string, test::persistent_traits>;
+
+persistent_binder make(int n) {
+    persistent_binder b;
+    for (int i = n - 1; i >= 0; --i)
+        b.insert_front(i, std::to_string(i));
+    return b;
+}
+
+void keeps_order() {
+    persistent_binder b;
+    b.insert_front(1, "a");
+    b.insert_after(1, 3, "c");
+    b.insert_after(1, 2, "b");
+    b.insert_front(0, "z");
+    CHECK((test::keys_of(b) == std::vector<int>{0, 1, 2, 3}));
+    b.remove(2);
+    b.remove();
+    CHECK((test::keys_of(b) == std::vector<int>{1, 3}));
+    CHECK_THROWS(b.insert_front(3, "x"), std::invalid_argument);
+    CHECK_THROWS(b.insert_after(7, 8, "x"), std::invalid_argument);
+    CHECK_THROWS(b.remove(7), std::invalid_argument);
+}
+
+// every copy is a snapshot that later modifications of the others don't reach
+void copies_are_snapshots() {
+    auto a = make(1000);
+    auto b = a;
+    a.remove(500);
+    a.read(3) = "x";
+    auto c = a;
+    a.read(3) = "y";
+    a.insert_after(10, 2000, "new");
+
+    CHECK(b.size() == 1000 && std::as_const(b).read(3) == "3" && std::as_const(b).read(500) == "500");
+    CHECK(!b.contains(2000));
+    CHECK(c.size() == 999 && std::as_const(c).read(3) == "x" && !c.contains(2000));
+    CHECK(a.size() == 1000 && std::as_const(a).read(3) == "y" && !a.contains(500));
+    CHECK(std::next(a.find(10)).key() == 2000);
+}
+
+// a modification of a shared binder copies a path of the tree, the values of the
+// notes it didn't touch stay shared
+void modifications_share_untouched_notes() {
+    auto a = make(10000);
+    auto b = a;
+    b.remove(5000);
+    b.insert_front(-1, "front");
+    for (int k : {0, 1, 4999, 5001, 9999})
+        CHECK(&std::as_const(a).read(k) == &std::as_const(b).read(k));
+    CHECK(a.size() == 10000 && b.size() == 10000);
+}
+
+// a reference from read() stays private to its binder while it may be in use
+void read_references_stay_private() {
+    auto a = make(10);
+    std::string& r = a.read(7);
+    r = "q";
+    auto d = a;
+    r = "w";
+    CHECK(std::as_const(d).read(7) == "q");
+    CHECK(std::as_const(a).read(7) == "w");
+}
+
+struct persistent_pmr_traits : test::persistent_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+using pmr_binder = binder<int, std::string, persistent_pmr_traits>;
+
+// an unshared binder is modified in place, allocating the new note only
+void unshared_modifications_copy_nothing() {
+    test::counting_resource res;
+    pmr_binder b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    for (int i = 0; i < 1000; ++i)
+        b.insert_front(i, "v");
+    res.allocations = 0;
+    b.insert_front(-1, "v");
+    b.insert_after(500, 2000, "v");
+    CHECK(res.allocations == 4);
+    b.remove(500);
+    b.remove();
+    b.remove(999);
+    CHECK(res.allocations == 4);
+    CHECK(b.size() == 999 && !b.contains(500) && !b.contains(-1) && b.cbegin().key() == 998);
+    CHECK(*std::next(b.find(501)) == "v" && std::next(b.find(501)).key() == 2000);
+}
+
+// a failure while copying shared nodes leaves both binders as they were
+void failed_copies_change_nothing() {
+    test::counting_resource res;
+    pmr_binder a{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    for (int i = 99; i >= 0; --i)
+        a.insert_front(i, std::to_string(i));
+    auto keys = test::keys_of(a);
+    for (long budget = 0; budget < 40; ++budget) {
+        auto b = a;
+        res.budget = budget;
+        try {
+            b.insert_after(50, 1000, "x");
+            b.remove(20);
+            b.insert_front(-1, "y");
+        }
+        catch (std::bad_alloc&) {
+        }
+        res.budget = -1;
+        CHECK(test::keys_of(a) == keys);
+        auto bk = test::keys_of(b);
+        CHECK(bk.size() == b.size());
+        for (int k : bk)
+            CHECK(std::as_const(b).read(k) == (k == 1000 ? "x" : k == -1 ? "y" : std::to_string(k)));
+    }
+}
+
+} // namespace
+
+int main() {
+    keeps_order();
+    copies_are_snapshots();
+    modifications_share_untouched_notes();
+    read_references_stay_private();
+    unshared_modifications_copy_nothing();
+    failed_copies_change_nothing();
+}
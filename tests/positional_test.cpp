@@ -0,0 +1,163 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct ranked_hash_traits : default_binder_traits {
+    using index = hash_index;
+    using storage = ranked_storage;
+};
+
+// random insertions and removals, positions checked against a list of keys
+template <typename Traits>
+void matches_model() {
+    using B = binder<int, long, Traits>;
+    B b;
+    std::list<int> model;
+    std::mt19937 gen{3};
+    CHECK(b.at_position(0) == b.cend());
+    auto random_note = [&] {
+        auto it = model.begin();
+        std::advance(it, gen() % model.size());
+        return it;
+    };
+    for (int i = 0; i < 1500; ++i) {
+        auto op = gen() % 4;
+        if (op < 2 || model.empty()) {
+            b.insert_front(i, i);
+            model.push_front(i);
+        }
+        else if (op == 2) {
+            auto it = random_note();
+            b.insert_after(*it, i, i);
+            model.insert(std::next(it), i);
+        }
+        else {
+            auto it = random_note();
+            b.remove(*it);
+            model.erase(it);
+        }
+        if (i % 97 == 0) {
+            std::size_t pos = 0;
+            for (int k : model) {
+                CHECK(b.position_of(k) == pos && b.at_position(pos).key() == k);
+                ++pos;
+            }
+            CHECK(b.at_position(pos) == b.cend());
+            CHECK(test::keys_of(b) == std::vector<int>(model.begin(), model.end()));
+
+            B c = b;
+            c.insert_front(-1 - i, 0);
+            CHECK(c.position_of(-1 - i) == 0 && c.size() == b.size() + 1);
+            CHECK(b.position_of(model.front()) == 0);
+        }
+    }
+    CHECK_THROWS(b.position_of(-5), std::invalid_argument);
+    CHECK_THROWS(B{}.position_of(1), std::invalid_argument);
+}
+
+// notes with keys in [lo, hi), in key order
+template <typename Traits>
+void ranges_of_keys() {
+    using B = binder<int, long, Traits>;
+    B b;
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; ++i) {
+        int k = i * 7919 % 1009;
+        b.insert_front(k, k);
+        keys.push_back(k);
+    }
+    std::vector<int> found;
+    for (auto [k, v] : b.key_range(100, 200)) {
+        found.push_back(k);
+        CHECK(k == static_cast<int>(v));
+    }
+    std::vector<int> expected;
+    std::ranges::copy_if(keys, std::back_inserter(expected), [](int k) { return k >= 100 && k < 200; });
+    std::ranges::sort(expected);
+    CHECK(found == expected);
+    CHECK(std::ranges::empty(b.key_range(200, 100)) && std::ranges::empty(b.key_range(2000, 3000)));
+    CHECK(std::ranges::empty(B{}.key_range(1, 5)));
+}
+
+// lookup keys work for positions and ranges as well
+void heterogeneous_keys() {
+    binder<std::string, int, test::ranked_traits> s;
+    s.insert_front("b", 1);
+    s.insert_front("a", 0);
+    CHECK(s.position_of(std::string_view{"b"}) == 1);
+    std::vector<std::string> found;
+    for (auto [k, v] : s.key_range(std::string_view{"a"}, std::string_view{"az"}))
+        found.push_back(k);
+    CHECK(found == std::vector<std::string>{"a"});
+}
+
+// copyable value whose copies throw once the budget runs out
+struct fragile {
+    static inline long budget = -1;
+
+    int v;
+
+    fragile(int x) : v{x} {}
+
+    fragile(fragile const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+    }
+
+    fragile& operator=(fragile const&) = default;
+};
+
+// a failing copy of ranked storage leaves both binders intact
+void failed_copies() {
+    binder<int, fragile, test::ranked_traits> b;
+    for (int i = 0; i < 500; ++i)
+        b.insert_front(i, fragile{i});
+    for (long budget = 0; budget < 600; budget += 7) {
+        b.read(3);
+        fragile::budget = budget;
+        try {
+            auto c = b;
+            CHECK(c.size() == 500 && budget >= 500);
+        }
+        catch (std::runtime_error&) {
+            CHECK(budget < 500);
+        }
+        fragile::budget = -1;
+        CHECK(b.size() == 500 && b.position_of(0) == 499);
+    }
+
+    auto c = b;
+    c.remove(4);
+    fragile::budget = 0;
+    CHECK_THROWS(c.insert_after(5, 1000, fragile{1}), std::runtime_error);
+    fragile::budget = -1;
+    CHECK(c.size() == 499 && c.position_of(5) == 494 && !c.contains(1000));
+}
+
+} // namespace
+
+int main() {
+    matches_model<test::ranked_traits>();
+    matches_model<ranked_hash_traits>();
+    matches_model<default_binder_traits>();
+    matches_model<test::persistent_traits>();
+    matches_model<test::slab_hash_traits>();
+    ranges_of_keys<test::ranked_traits>();
+    ranges_of_keys<default_binder_traits>();
+    heterogeneous_keys();
+    failed_copies();
+}
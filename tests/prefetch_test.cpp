@@ -0,0 +1,295 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <memory>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// runs every copy on a thread of its own, which join_all() waits for; copies
+// don't start while held
+struct joined_executor {
+    static constexpr bool enabled = true;
+    static inline std::mutex lock;
+    static inline std::vector<std::thread> threads;
+    static inline std::atomic<bool> held{false};
+
+    template <typename F>
+    static void execute(F&& task) {
+        std::lock_guard guard{lock};
+        threads.emplace_back([task = std::forward<F>(task)]() mutable {
+            while (held.load())
+                std::this_thread::yield();
+            task();
+        });
+    }
+
+    static void join_all() {
+        std::lock_guard guard{lock};
+        for (auto& t : threads)
+            t.join();
+        threads.clear();
+    }
+};
+
+struct prefetch_traits : default_binder_traits {
+    using clone_executor = joined_executor;
+};
+
+struct prefetch_slab_traits : prefetch_traits {
+    using index = lazy_index<hash_index>;
+    using storage = slab_storage;
+    using values = shared_values;
+};
+
+struct prefetch_compact_traits : prefetch_traits {
+    using refcount = intrusive_refcount;
+};
+
+struct prefetch_persistent_traits : prefetch_traits {
+    using storage = persistent_storage;
+};
+
+struct local_traits : prefetch_traits {
+    using refcount = local_refcount;
+};
+
+struct prefetch_pmr_traits : prefetch_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+struct detached_traits : default_binder_traits {
+    using clone_executor = thread_clone_executor;
+};
+
+template <typename B>
+concept can_prefetch = requires(B b) { b.prefetch_unshare(); };
+
+static_assert(can_prefetch<binder<int, int, prefetch_traits>>);
+static_assert(can_prefetch<binder<int, int, detached_traits>>);
+static_assert(!can_prefetch<binder<int, int>>);
+static_assert(!can_prefetch<binder<int, int, local_traits>>);
+static_assert(sizeof(binder<int, int>) == sizeof(std::shared_ptr<int>));
+
+template <typename B>
+B make(int n) {
+    B b;
+    for (int i = 0; i < n; ++i)
+        b.insert_front(i, std::to_string(i));
+    return b;
+}
+
+// the next modification takes the prefetched copy over instead of cloning
+template <typename Traits>
+void takes_prefetched_clone() {
+    using B = binder<int, std::string, Traits>;
+    auto b = make<B>(10000);
+    auto snap = b;
+    auto before = global_clone_counters.on_write.load();
+    b.prefetch_unshare();
+    b.prefetch_unshare();
+    CHECK(b.is_shared());
+    b.insert_front(-1, "x");
+    CHECK(global_clone_counters.on_write.load() == before + 1);
+    CHECK(b.size() == 10001 && snap.size() == 10000 && !snap.contains(-1) && !b.is_shared());
+
+    // unshared data isn't copied
+    B u = make<B>(1);
+    before = global_clone_counters.on_write.load();
+    u.prefetch_unshare();
+    u.insert_front(1, "1");
+    CHECK(global_clone_counters.on_write.load() == before && !u.is_shared());
+    joined_executor::join_all();
+}
+
+// a prefetched copy is discarded whenever it may be out of date
+template <typename Traits>
+void discards_stale_clones() {
+    using B = binder<int, std::string, Traits>;
+    auto b = make<B>(1000);
+
+    // the other owner lets go
+    auto s2 = b;
+    b.prefetch_unshare();
+    s2 = B{};
+    b.remove(0);
+    CHECK(b.size() == 999 && !b.contains(0));
+
+    // assignment
+    auto s3 = b;
+    b.prefetch_unshare();
+    b = s3;
+    b.insert_front(-2, "y");
+    CHECK(!s3.contains(-2) && b.contains(-2));
+
+    // writes through read() and write handles
+    auto s4 = b;
+    b.prefetch_unshare();
+    b.read(5) = "five";
+    CHECK(std::as_const(s4).read(5) == "5");
+    b.insert_front(-3, "z");
+    CHECK(std::as_const(b).read(5) == "five");
+    auto s5 = b;
+    b.prefetch_unshare();
+    {
+        auto h = b.write(6);
+        *h = "six";
+    }
+    b.insert_front(-4, "w");
+    CHECK(std::as_const(b).read(6) == "six" && std::as_const(s5).read(6) == "6");
+
+    // clear
+    auto s6 = b;
+    b.prefetch_unshare();
+    b.clear();
+    b.insert_front(1, "1");
+    CHECK(b.size() == 1 && s6.size() > 1);
+    joined_executor::join_all();
+}
+
+// a binder unshared by read() or write() doesn't keep its prefetched copy around
+void releases_unused_clones() {
+    using B = binder<int, std::string, prefetch_pmr_traits>;
+    test::counting_resource res;
+    B b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    for (int i = 0; i < 100; ++i)
+        b.insert_front(i, "a rather long value of note " + std::to_string(i));
+    auto single = res.in_use;
+
+    B s{b, b.get_allocator()};
+    b.prefetch_unshare();
+    joined_executor::join_all();
+    CHECK(res.in_use == 2 * single);
+    b.read(5) = "five";
+    CHECK(res.in_use == 2 * single);
+
+    s = b;
+    b.prefetch_unshare();
+    joined_executor::join_all();
+    {
+        auto h = b.write(6);
+        *h = "six";
+    }
+    CHECK(res.in_use == 2 * single);
+
+    // the other owner lets go after the copy was started
+    s = b;
+    b.prefetch_unshare();
+    joined_executor::join_all();
+    s = B{b.get_allocator()};
+    b.read(7) = "seven";
+    CHECK(res.in_use == single);
+
+    s = b;
+    b.prefetch_unshare();
+    joined_executor::join_all();
+    s = B{b.get_allocator()};
+    {
+        auto h = b.write(8);
+        *h = "eight";
+    }
+    CHECK(res.in_use == single);
+}
+
+// moves carry the prefetched copy along, other owners may modify concurrently
+template <typename Traits>
+void moves_and_concurrent_owners() {
+    using B = binder<int, std::string, Traits>;
+    auto b = make<B>(1000);
+    auto s = b;
+    b.prefetch_unshare();
+    B m = std::move(b);
+    m.read(5) = "five";
+    CHECK(std::as_const(s).read(5) == "5");
+
+    auto t = m;
+    m.prefetch_unshare();
+    std::thread writer([&t] {
+        for (int i = 0; i < 100; ++i)
+            t.insert_front(100000 + i, "t");
+    });
+    m.insert_front(-3, "m");
+    writer.join();
+    CHECK(m.contains(-3) && !t.contains(-3) && !m.contains(100000) && t.contains(100099));
+
+    auto copy = m;
+    m.prefetch_unshare();
+    auto notes = std::move(m).extract_all();
+    CHECK(notes.size() == copy.size());
+
+    auto other = copy;
+    copy.prefetch_unshare();
+    B e;
+    e.merge(std::move(copy));
+    e.insert_front(-100, "q");
+    CHECK(!other.contains(-100) && e.size() == other.size() + 1);
+    joined_executor::join_all();
+}
+
+// a copy in progress isn't an owner of the data, a binder whose other owners let go
+// is alone and hands its notes over without copies
+template <typename Traits>
+void copies_in_progress_dont_share() {
+    using B = binder<int, std::string, Traits>;
+    auto b = make<B>(1000);
+    auto s = b;
+    joined_executor::held = true;
+    b.prefetch_unshare();
+    CHECK(b.is_shared() && b.stats().use_count == 2);
+    s = B{};
+    CHECK(!b.is_shared() && b.stats().use_count == 1);
+    joined_executor::held = false;
+    b.insert_front(-1, "x");
+    CHECK(b.size() == 1001 && !b.is_shared() && !s.contains(-1));
+
+    auto c = make<B>(10);
+    auto c2 = c;
+    joined_executor::held = true;
+    c.prefetch_unshare();
+    c2 = B{};
+    CHECK(!c.is_shared());
+    std::string const* value = &std::as_const(c).read(5);
+    joined_executor::held = false;
+    B d;
+    d.merge(std::move(c));
+    CHECK(d.size() == 10 && &std::as_const(d).read(5) == value);
+    joined_executor::join_all();
+}
+
+// the executor that ships with the binder
+void detached_threads() {
+    auto b = make<binder<int, std::string, detached_traits>>(1000);
+    auto s = b;
+    b.prefetch_unshare();
+    b.insert_front(-1, "x");
+    CHECK(b.size() == 1001 && !s.contains(-1));
+}
+
+} // namespace
+
+int main() {
+    takes_prefetched_clone<prefetch_traits>();
+    takes_prefetched_clone<prefetch_slab_traits>();
+    takes_prefetched_clone<prefetch_compact_traits>();
+    takes_prefetched_clone<prefetch_persistent_traits>();
+    discards_stale_clones<prefetch_traits>();
+    discards_stale_clones<prefetch_slab_traits>();
+    discards_stale_clones<prefetch_compact_traits>();
+    discards_stale_clones<prefetch_persistent_traits>();
+    moves_and_concurrent_owners<prefetch_traits>();
+    moves_and_concurrent_owners<prefetch_slab_traits>();
+    moves_and_concurrent_owners<prefetch_compact_traits>();
+    copies_in_progress_dont_share<prefetch_traits>();
+    copies_in_progress_dont_share<prefetch_slab_traits>();
+    copies_in_progress_dont_share<prefetch_compact_traits>();
+    releases_unused_clones();
+    detached_threads();
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <utility>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct small_traits : default_binder_traits {
+    using index = small_index<8>;
+};
+
+template <typename Traits>
+void builds_in_order() {
+    using B = binder<int, std::string, Traits>;
+    B a{{3, "c"}, {1, "a"}, {2, "b"}};
+    CHECK((test::keys_of(a) == std::vector<int>{3, 1, 2}));
+    CHECK(std::as_const(a).read(1) == "a");
+
+    std::map<int, std::string> m{{5, "e"}, {4, "d"}};
+    B b(from_range, m);
+    CHECK((test::keys_of(b) == std::vector<int>{4, 5}));
+    CHECK(m.size() == 2 && m[4] == "d");
+
+    std::vector<std::pair<int, std::string>> v;
+    for (int i = 0; i < 1000; ++i)
+        v.emplace_back(i, std::string(20, 'x') + std::to_string(i));
+    B c(from_range, v);
+    CHECK(c.size() == 1000);
+    for (int i = 0; i < 1000; ++i)
+        CHECK(std::as_const(c).read(i) == v[i].second);
+    c.insert_front(-1, "front");
+    c.remove(500);
+    CHECK(c.size() == 1000 && !c.contains(500));
+
+    B empty(from_range, std::vector<std::pair<int, std::string>>{});
+    CHECK(empty.size() == 0);
+}
+
+// an rvalue range is moved from
+template <typename Traits>
+void moves_from_rvalue_ranges() {
+    using B = binder<int, std::string, Traits>;
+    std::vector<std::pair<int, std::string>> v{{1, std::string(50, 'a')}, {2, std::string(50, 'b')}};
+    B b(from_range, std::move(v));
+    CHECK(std::as_const(b).read(1) == std::string(50, 'a'));
+    CHECK(v[0].second.empty() && v[1].second.empty());
+}
+
+// single-pass input ranges work as well
+template <typename Traits>
+void reads_input_ranges() {
+    using B = binder<int, int, Traits>;
+    std::istringstream in{"1 2 3 4"};
+    auto numbers = std::ranges::subrange(std::istream_iterator<int>{in}, std::istream_iterator<int>{})
+        | std::views::transform([](int i) { return std::pair<int, int>{i, i * i}; });
+    B b(from_range, numbers);
+    CHECK((test::keys_of(b) == std::vector<int>{1, 2, 3, 4}));
+    CHECK(std::as_const(b).read(4) == 16);
+}
+
+template <typename Traits>
+void rejects_repeated_keys() {
+    using B = binder<int, std::string, Traits>;
+    CHECK_THROWS((B{{1, "a"}, {2, "b"}, {1, "c"}}), std::invalid_argument);
+    std::list<std::pair<int, std::string>> l;
+    for (int i = 0; i < 500; ++i)
+        l.emplace_back(i, "v");
+    l.emplace_back(250, "again");
+    CHECK_THROWS(B(from_range, l), std::invalid_argument);
+}
+
+} // namespace
+
+int main() {
+    builds_in_order<default_binder_traits>();
+    builds_in_order<test::hash_traits>();
+    builds_in_order<test::slab_hash_traits>();
+    builds_in_order<test::persistent_traits>();
+    builds_in_order<small_traits>();
+    moves_from_rvalue_ranges<default_binder_traits>();
+    moves_from_rvalue_ranges<test::slab_hash_traits>();
+    reads_input_ranges<default_binder_traits>();
+    reads_input_ranges<test::hash_traits>();
+    reads_input_ranges<test::persistent_traits>();
+    rejects_repeated_keys<default_binder_traits>();
+    rejects_repeated_keys<test::hash_traits>();
+    rejects_repeated_keys<test::slab_hash_traits>();
+    rejects_repeated_keys<test::persistent_traits>();
+    rejects_repeated_keys<small_traits>();
+}
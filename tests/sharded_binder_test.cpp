@@ -0,0 +1,93 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <type_traits>
+
+#include "sharded_binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// every key in one shard
+struct constant_hash {
+    std::size_t operator()(int) const noexcept {
+        return 7;
+    }
+};
+
+template <typename S>
+std::vector<int> keys_in_order(S const& s) {
+    std::vector<int> keys;
+    s.for_each([&keys](int k, auto const&) { keys.push_back(k); });
+    return keys;
+}
+
+template <typename S>
+void behaves_like_a_binder() {
+    S s;
+    s.insert_front(2, "b");
+    s.insert_front(1, "a");
+    s.insert_after(2, 3, "c");
+    s.insert_after(1, 4, "d");
+    CHECK((keys_in_order(s) == std::vector<int>{1, 4, 2, 3}));
+    CHECK(s.size() == 4 && s.read(3) == "c" && s.contains(4) && !s.contains(5));
+
+    CHECK_THROWS(s.insert_front(1, "x"), std::invalid_argument);
+    CHECK_THROWS(s.insert_after(9, 5, "x"), std::invalid_argument);
+    CHECK_THROWS(s.insert_after(1, 2, "x"), std::invalid_argument);
+    CHECK_THROWS(s.read(9), std::invalid_argument);
+    CHECK_THROWS(s.remove(9), std::invalid_argument);
+    CHECK(s.size() == 4);
+
+    s.modify(4, [](std::string& v) { v = "m"; });
+    CHECK(s.read(4) == "m");
+    auto&& r = s.modify(4, [](std::string& v) -> std::string const& { return v; });
+    static_assert(std::is_same_v<decltype(r), std::string&&>);
+    CHECK(r == "m");
+    s.remove(1);
+    s.remove(3);
+    CHECK((keys_in_order(s) == std::vector<int>{4, 2}));
+
+    auto b = s.to_binder();
+    CHECK((test::keys_of(b) == std::vector<int>{4, 2}));
+    CHECK(std::as_const(b).read(4) == "m");
+}
+
+// writers of disjoint keys, one of them inserting after the notes of another
+void concurrent_writers() {
+    sharded_binder<int, int> s;
+    s.insert_front(-1, 0);
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w)
+        writers.emplace_back([&s, w] {
+            for (int i = 0; i < 2000; ++i) {
+                int k = w * 100000 + i;
+                if (i % 2 == 0)
+                    s.insert_front(k, w);
+                else
+                    s.insert_after(-1, k, w);
+                if (i % 5 == 0)
+                    s.remove(k);
+                s.modify(-1, [](int& v) { ++v; });
+            }
+        });
+    for (auto& t : writers)
+        t.join();
+    CHECK(s.size() == 1 + 4 * (2000 - 400));
+    CHECK(s.read(-1) == 4 * 2000);
+    CHECK(keys_in_order(s).size() == s.size());
+    for (int w = 0; w < 4; ++w)
+        CHECK(s.contains(w * 100000 + 1) && !s.contains(w * 100000 + 5));
+}
+
+} // namespace
+
+int main() {
+    behaves_like_a_binder<sharded_binder<int, std::string>>();
+    behaves_like_a_binder<sharded_binder<int, std::string, 1>>();
+    behaves_like_a_binder<sharded_binder<int, std::string, 4, constant_hash>>();
+    concurrent_writers();
+}
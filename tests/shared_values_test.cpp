@@ -0,0 +1,138 @@
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// value that counts its copies
+struct blob {
+    static inline long copies = 0;
+
+    std::string s;
+
+    blob(std::string x) : s{std::move(x)} {}
+
+    blob(blob const& rhs) : s{rhs.s} {
+        ++copies;
+    }
+
+    blob(blob&&) noexcept = default;
+    blob& operator=(blob const&) = default;
+};
+
+struct shared_traits : default_binder_traits {
+    using values = shared_values;
+};
+
+struct shared_slab_traits : default_binder_traits {
+    using values = shared_values;
+    using index = hash_index;
+    using storage = slab_storage;
+};
+
+struct shared_ranked_traits : default_binder_traits {
+    using values = shared_values;
+    using storage = ranked_storage;
+};
+
+struct shared_lazy_traits : default_binder_traits {
+    using values = shared_values;
+    using index = lazy_index<>;
+};
+
+template <typename B>
+B make(int n) {
+    B b;
+    for (int i = 0; i < n; ++i)
+        b.insert_front(i, blob{std::to_string(i)});
+    return b;
+}
+
+// a clone copies the values that are modified or may be through a reference only
+template <typename Traits>
+void copies_values_on_write() {
+    using B = binder<int, blob, Traits>;
+    auto b = make<B>(100);
+    blob::copies = 0;
+    auto c = b;
+    c.read(5).s = "five";
+    CHECK(blob::copies == 1);
+    CHECK(std::as_const(b).read(5).s == "5" && std::as_const(c).read(5).s == "five");
+
+    // c handed out a reference to value 5, a copy of c must not share it
+    blob::copies = 0;
+    auto d = c;
+    CHECK(blob::copies == 1);
+    c.read(5).s = "changed";
+    CHECK(std::as_const(d).read(5).s == "five");
+
+    blob::copies = 0;
+    auto& r = c.read(7);
+    auto e = c;
+    r.s = "x";
+    CHECK(std::as_const(e).read(7).s == "7" && std::as_const(c).read(7).s == "x");
+    CHECK(blob::copies < 10);
+    for (int i = 0; i < 100; ++i)
+        CHECK(std::as_const(e).read(i).s == std::as_const(b).read(i).s || i == 5);
+
+    // a handle makes copies deep for its value only while it lives
+    {
+        auto h = b.write(9);
+        auto f = b;
+        h->s = "nine";
+        CHECK(std::as_const(f).read(9).s == "9");
+    }
+    CHECK(std::as_const(b).read(9).s == "nine");
+    blob::copies = 0;
+    auto g = b;
+    g.remove(0);
+    CHECK(blob::copies == 0);
+}
+
+// the other operations see the shared values like inline ones
+template <typename Traits>
+void other_operations() {
+    using B = binder<int, blob, Traits>;
+    auto b = make<B>(100);
+    b.insert_front(1000, blob{"k"});
+    CHECK(b.take(1000).s == "k");
+
+    auto g = b;
+    CHECK(g.take(3).s == "3" && b.contains(3));
+    auto all = std::move(g).extract_all();
+    CHECK(all.size() == 99 && b.size() == 100);
+    for (auto& [k, v] : all)
+        CHECK(v.s == std::to_string(k));
+
+    B m;
+    m.insert_front(-1, blob{"m"});
+    auto n = b;
+    m.merge(std::move(n));
+    CHECK(m.size() == 101 && std::as_const(m).read(9).s == "9");
+    m.read(9).s = "nine";
+    CHECK(std::as_const(b).read(9).s == "9");
+    CHECK(b.stats().storage_bytes > 0);
+
+    std::vector<std::pair<int, blob>> src;
+    src.emplace_back(5000, blob{"a"});
+    B q(from_range, src);
+    CHECK(std::as_const(q).read(5000).s == "a");
+}
+
+} // namespace
+
+int main() {
+    copies_values_on_write<shared_traits>();
+    copies_values_on_write<shared_slab_traits>();
+    copies_values_on_write<shared_ranked_traits>();
+    copies_values_on_write<shared_lazy_traits>();
+    other_operations<shared_traits>();
+    other_operations<shared_slab_traits>();
+    other_operations<shared_ranked_traits>();
+    other_operations<shared_lazy_traits>();
+}
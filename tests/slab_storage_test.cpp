@@ -0,0 +1,95 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+template <typename Traits>
+void keeps_order() {
+    binder<int, std::string, Traits> b;
+    b.insert_front(1, "a");
+    b.insert_after(1, 2, "b");
+    b.insert_after(1, 3, "c");
+    b.insert_front(4, "d");
+    CHECK((test::keys_of(b) == std::vector<int>{4, 1, 3, 2}));
+    CHECK((test::values_of(b) == std::vector<std::string>{"d", "a", "c", "b"}));
+    b.remove(3);
+    b.remove();
+    CHECK((test::keys_of(b) == std::vector<int>{1, 2}));
+    b.insert_after(2, 5, "e");
+    CHECK((test::keys_of(b) == std::vector<int>{1, 2, 5}));
+}
+
+// references returned by read() stay valid while other notes come and go
+template <typename Traits>
+void values_stay_in_place() {
+    binder<int, std::string, Traits> b;
+    b.insert_front(0, "zero");
+    std::string& zero = b.read(0);
+    for (int i = 1; i < 1000; ++i)
+        b.insert_front(i, std::to_string(i));
+    for (int i = 1; i < 1000; i += 2)
+        b.remove(i);
+    CHECK(zero == "zero");
+    CHECK(&zero == &b.read(0));
+}
+
+// slots of removed notes are reused, churn doesn't grow the storage
+template <typename Traits>
+void reuses_slots() {
+    binder<int, int, Traits> b;
+    for (int i = 0; i < 256; ++i)
+        b.insert_front(i, i);
+    auto bytes = b.stats().storage_bytes;
+    std::mt19937 gen{3};
+    for (int round = 0; round < 20; ++round) {
+        std::vector<int> removed;
+        for (int i = 0; i < 100; ++i) {
+            int k = static_cast<int>(gen() % 256);
+            if (b.contains(k)) {
+                b.remove(k);
+                removed.push_back(k);
+            }
+        }
+        for (int k : removed)
+            b.insert_front(k, k);
+        CHECK(b.size() == 256);
+    }
+    CHECK(b.stats().storage_bytes == bytes);
+    for (int i = 0; i < 256; ++i)
+        CHECK(std::as_const(b).read(i) == i);
+}
+
+template <typename Traits>
+void copies_are_independent() {
+    binder<int, std::string, Traits> a;
+    for (int i = 0; i < 50; ++i)
+        a.insert_front(i, std::to_string(i));
+    auto b = a;
+    b.remove(10);
+    b.insert_after(20, 100, "x");
+    b.read(30) = "changed";
+    CHECK(a.size() == 50 && a.contains(10) && !a.contains(100));
+    CHECK(std::as_const(a).read(30) == "30");
+    CHECK(b.size() == 50 && std::as_const(b).read(30) == "changed");
+    CHECK(std::next(b.find(20)).key() == 100);
+}
+
+} // namespace
+
+int main() {
+    keeps_order<test::slab_traits>();
+    keeps_order<test::slab_hash_traits>();
+    values_stay_in_place<test::slab_traits>();
+    values_stay_in_place<test::slab_hash_traits>();
+    reuses_slots<test::slab_traits>();
+    reuses_slots<test::slab_hash_traits>();
+    copies_are_independent<test::slab_traits>();
+    copies_are_independent<test::slab_hash_traits>();
+}
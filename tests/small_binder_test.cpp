@@ -0,0 +1,127 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct inline_hash_traits : default_binder_traits {
+    using index = hash_index;
+    using storage = inline_slab_storage<2>;
+};
+
+struct inline_ordered_traits : default_binder_traits {
+    using storage = inline_slab_storage<4>;
+};
+
+template <std::size_t N>
+struct small_pmr_traits : small_binder_traits<N> {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+// up to N notes take a single allocation, also for a copy that modifies them
+template <std::size_t N>
+void single_allocation() {
+    test::counting_resource res;
+    binder<int, long, small_pmr_traits<N>> b{std::pmr::polymorphic_allocator<std::byte>{&res}};
+    for (std::size_t i = 0; i < N; ++i)
+        b.insert_front(static_cast<int>(i), 1);
+    CHECK(res.allocations == 1);
+
+    binder<int, long, small_pmr_traits<N>> c{b, b.get_allocator()};
+    c.remove(0);
+    CHECK(res.allocations == 2);
+    CHECK(b.size() == N && c.size() == N - 1);
+
+    // one more note spills out of the shared block
+    b.insert_front(-1, 1);
+    CHECK(b.size() == N + 1 && res.allocations > 2);
+    CHECK(std::as_const(b).read(static_cast<int>(N - 1)) == 1);
+}
+
+// random insertions, removals, copies and moves checked against a plain vector of notes
+template <typename B>
+void matches_model() {
+    std::mt19937 gen{5};
+    for (int round = 0; round < 20; ++round) {
+        B b;
+        std::vector<std::pair<int, std::string>> model;
+        auto find = [&model](int k) {
+            return std::ranges::find(model, k, &std::pair<int, std::string>::first);
+        };
+        for (int i = 0; i < 1000; ++i) {
+            int k = static_cast<int>(gen() % (round * 3 + 3));
+            auto it = find(k);
+            switch (gen() % 4) {
+            case 0:
+                if (it == model.end()) {
+                    b.insert_front(k, std::to_string(i));
+                    model.insert(model.begin(), {k, std::to_string(i)});
+                }
+                break;
+            case 1:
+                if (it == model.end() && !model.empty()) {
+                    auto prev = model.begin() + static_cast<std::ptrdiff_t>(gen() % model.size());
+                    b.insert_after(prev->first, k, "a" + std::to_string(k));
+                    model.insert(prev + 1, {k, "a" + std::to_string(k)});
+                }
+                break;
+            case 2:
+                if (it != model.end()) {
+                    b.remove(k);
+                    model.erase(it);
+                }
+                break;
+            default: {
+                B c = b;
+                if (!model.empty()) {
+                    c.read(model.front().first) = "changed";
+                    CHECK(std::as_const(b).read(model.front().first) == model.front().second);
+                }
+                B d = std::move(c);
+                B e;
+                e = std::move(d);
+                CHECK(e.size() == b.size());
+                for (auto& [key, v] : model)
+                    CHECK(e.contains(key));
+            }
+            }
+            CHECK(b.size() == model.size());
+        }
+        std::vector<std::string> values;
+        for (auto& [k, v] : model)
+            values.push_back(v);
+        CHECK(test::values_of(b) == values);
+
+        // moving out of unshared data keeps every note reachable by its key
+        B moved = std::move(b);
+        for (auto& [k, v] : model)
+            CHECK(std::as_const(moved).read(k) == v);
+        auto notes = std::move(moved).extract_all();
+        CHECK(notes == model);
+    }
+}
+
+} // namespace
+
+int main() {
+    single_allocation<2>();
+    single_allocation<5>();
+    single_allocation<16>();
+    matches_model<small_binder<int, std::string, 2>>();
+    matches_model<small_binder<int, std::string, 5>>();
+    matches_model<small_binder<int, std::string, 16>>();
+    matches_model<binder<int, std::string, inline_hash_traits>>();
+    matches_model<binder<int, std::string, inline_ordered_traits>>();
+
+    small_binder<std::string, int, 2> s;
+    s.insert_front("x", 1);
+    CHECK(std::as_const(s).read("x") == 1);
+}
@@ -0,0 +1,101 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+struct small_hash_traits : default_binder_traits {
+    using index = small_index<>;
+};
+
+struct small_ordered_traits : default_binder_traits {
+    using index = small_index<8, ordered_index>;
+    using storage = slab_storage;
+};
+
+struct small_pmr_traits : pmr::binder_traits {
+    using index = small_index<16>;
+};
+
+enum class id : std::uint16_t {};
+
+// random insertions, removals and lookups checked against a plain vector of notes,
+// with key ranges that keep the binder around the threshold
+template <typename B, typename Key, typename MakeKey>
+void matches_model(MakeKey make_key) {
+    std::mt19937 gen{3};
+    for (int round = 0; round < 20; ++round) {
+        B b;
+        std::vector<std::pair<Key, int>> model;
+        auto find = [&model](Key k) {
+            return std::ranges::find(model, k, &std::pair<Key, int>::first);
+        };
+        int range = (round % 5 + 1) * 40;
+        for (int i = 0; i < 2000; ++i) {
+            Key k = make_key(static_cast<int>(gen() % range));
+            auto it = find(k);
+            switch (gen() % 3) {
+            case 0:
+                if (it == model.end()) {
+                    b.insert_front(k, i);
+                    model.insert(model.begin(), {k, i});
+                }
+                else
+                    CHECK_THROWS(b.insert_front(k, i), std::invalid_argument);
+                break;
+            case 1:
+                if (it != model.end()) {
+                    b.remove(k);
+                    model.erase(it);
+                }
+                else
+                    CHECK_THROWS(b.remove(k), std::invalid_argument);
+                break;
+            default:
+                CHECK(b.contains(k) == (it != model.end()));
+                if (it != model.end())
+                    CHECK(std::as_const(b).read(k) == it->second);
+            }
+            if (i % 101 == 0) {
+                B c = b;
+                if (!model.empty())
+                    c.read(model.front().first) = -1;
+                B d = c;
+                CHECK(d.size() == b.size());
+            }
+        }
+        std::vector<int> values;
+        for (auto& [k, v] : model)
+            values.push_back(v);
+        CHECK(test::values_of(b) == values);
+    }
+}
+
+// keys that can't be packed use the large index from the start
+void other_keys() {
+    binder<std::string, int, small_hash_traits> b;
+    b.insert_front("a", 1);
+    b.insert_front("b", 2);
+    CHECK(std::as_const(b).read("a") == 1 && !b.contains("c"));
+}
+
+} // namespace
+
+int main() {
+    auto ints = [](int x) { return x; };
+    matches_model<binder<int, int, small_hash_traits>, int>(ints);
+    matches_model<binder<int, int, small_ordered_traits>, int>(ints);
+    matches_model<binder<long, int, small_ordered_traits>, long>([](int x) { return x * 1000000007L; });
+    matches_model<binder<char, int, small_hash_traits>, char>([](int x) { return static_cast<char>(x % 120); });
+    matches_model<binder<id, int, small_hash_traits>, id>([](int x) { return id(x); });
+    matches_model<binder<short, int, small_pmr_traits>, short>([](int x) { return static_cast<short>(x); });
+    other_keys();
+}
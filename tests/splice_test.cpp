@@ -0,0 +1,244 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <memory_resource>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// value that counts its copies, which throw once the budget runs out;
+// moves don't throw, but only say so if Noexcept
+template <bool Noexcept>
+struct value {
+    static inline long copies = 0;
+    static inline long budget = -1;
+
+    int v;
+
+    value(int x) : v{x} {}
+
+    value(value const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+        ++copies;
+    }
+
+    value(value&& rhs) noexcept(Noexcept) : v{rhs.v} {}
+
+    value& operator=(value const&) = default;
+};
+
+using movable = value<true>;
+using copied = value<false>;
+
+struct small_traits : default_binder_traits {
+    using index = small_index<8>;
+};
+
+struct lazy_slab_traits : default_binder_traits {
+    using index = lazy_index<hash_index>;
+    using storage = slab_storage;
+};
+
+// binder with the notes lo..hi-1 in order
+template <typename B>
+B make(int lo, int hi, typename B::allocator_type const& a = {}) {
+    B b{a};
+    for (int i = hi - 1; i >= lo; --i)
+        b.insert_front(i, i);
+    return b;
+}
+
+// keys of b in order, checking that each is found with its own value
+template <typename B>
+std::vector<int> checked_keys(B const& b) {
+    std::vector<int> res;
+    for (auto it = b.cbegin(); it != b.cend(); ++it) {
+        CHECK(b.read(it.key()).v == it.key());
+        res.push_back(it.key());
+    }
+    return res;
+}
+
+// notes move between binders, without copies where the storage allows
+template <typename Traits>
+void moves_notes(bool without_copies) {
+    using B = binder<int, movable, Traits>;
+    auto a = make<B>(0, 10);
+    auto b = make<B>(10, 20);
+    movable::copies = 0;
+    a.splice_after(4, std::move(b));
+    CHECK(!without_copies || movable::copies == 0);
+    CHECK(b.size() == 0 && a.size() == 20);
+    CHECK((checked_keys(a) == std::vector<int>{0, 1, 2, 3, 4, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 5, 6, 7, 8, 9}));
+    for (int i = 0; i < 20; ++i)
+        CHECK(a.contains(i));
+    a.remove(12);
+    a.insert_after(11, 1000, 1000);
+    a.remove(1000);
+
+    movable::copies = 0;
+    auto t = a.split_after(14);
+    CHECK(!without_copies || movable::copies == 0);
+    CHECK((checked_keys(a) == std::vector<int>{0, 1, 2, 3, 4, 10, 11, 13, 14}));
+    CHECK((checked_keys(t) == std::vector<int>{15, 16, 17, 18, 19, 5, 6, 7, 8, 9}));
+    for (int k : test::keys_of(t))
+        CHECK(!a.contains(k));
+    t.insert_after(9, 50, 50);
+    a.insert_front(50, 50);
+    CHECK(a.split_after(14).size() == 0 && a.size() == 10);
+    CHECK_THROWS(a.split_after(500), std::invalid_argument);
+    CHECK_THROWS(B{}.split_after(1), std::invalid_argument);
+
+    // a shared source is copied and its other owners keep their notes
+    auto c = make<B>(200, 205);
+    auto c2 = c;
+    a.merge(std::move(c));
+    CHECK(c.size() == 0 && c2.size() == 5 && a.size() == 15);
+    CHECK(std::prev(a.cend()).key() == 204);
+
+    // a shared destination is cloned first
+    auto a2 = a;
+    a.splice_front(make<B>(300, 303));
+    CHECK(a.size() == 18 && a2.size() == 15 && a.cbegin().key() == 300);
+    auto s1 = a;
+    auto s2 = s1.split_after(0);
+    CHECK(a.size() == 18 && s1.size() + s2.size() == 18);
+
+    B e;
+    e.merge(make<B>(1, 3));
+    B f;
+    f.splice_front(std::move(e));
+    CHECK(f.size() == 2 && e.size() == 0);
+    auto g = f.split_after(1);
+    CHECK(f.size() == 1 && g.size() == 1);
+}
+
+// rejected splices change neither binder
+template <typename Traits>
+void rejects_splices() {
+    using B = binder<int, movable, Traits>;
+    auto a = make<B>(0, 10);
+    auto d = make<B>(5, 12);
+    CHECK_THROWS(a.merge(std::move(d)), std::invalid_argument);
+    CHECK(d.size() == 7 && checked_keys(a) == test::keys_of(make<B>(0, 10)));
+    CHECK_THROWS(a.splice_after(-1, make<B>(500, 501)), std::invalid_argument);
+    CHECK_THROWS(B{}.splice_after(1, make<B>(500, 501)), std::invalid_argument);
+    CHECK(a.size() == 10 && !a.contains(500));
+}
+
+// a copy failing halfway through a splice or split leaves both binders as they were;
+// unless relinks, the notes of an unshared source are copied as well
+template <typename Traits>
+void failed_copies_change_nothing(bool relinks) {
+    using B = binder<int, copied, Traits>;
+    auto a = make<B>(0, 10);
+    auto keys = test::keys_of(a);
+    for (bool shared : {false, true}) {
+        if (relinks && !shared)
+            continue;
+        auto b = make<B>(10, 20);
+        B b2;
+        if (shared)
+            b2 = b;
+        copied::budget = 5;
+        CHECK_THROWS(a.splice_after(4, std::move(b)), std::runtime_error);
+        copied::budget = -1;
+        CHECK(checked_keys(a) == keys && checked_keys(b) == test::keys_of(make<B>(10, 20)));
+        CHECK(!shared || b2.size() == 10);
+        for (int i = 0; i < 10; ++i)
+            CHECK(a.contains(i) && !a.contains(i + 10) && b.contains(i + 10));
+
+        auto a2 = a;
+        copied::budget = 3;
+        try {
+            auto t = a.split_after(2);
+            CHECK(a.size() == 3 && t.size() == 7);
+            a.merge(std::move(t));
+        }
+        catch (std::runtime_error&) {
+        }
+        copied::budget = -1;
+        CHECK(checked_keys(a) == keys && checked_keys(a2) == keys);
+    }
+
+    auto t = a.split_after(2);
+    CHECK(a.size() == 3 && t.size() == 7);
+    for (int i = 3; i < 10; ++i)
+        CHECK(!a.contains(i) && t.contains(i));
+    a.merge(make<B>(10, 13));
+    CHECK(a.size() == 6);
+}
+
+// binders with unequal allocators copy the notes
+void copies_between_resources() {
+    std::pmr::monotonic_buffer_resource r1;
+    std::pmr::monotonic_buffer_resource r2;
+    pmr::binder<int, movable> x{std::pmr::polymorphic_allocator<std::byte>{&r1}};
+    pmr::binder<int, movable> y{std::pmr::polymorphic_allocator<std::byte>{&r2}};
+    x.insert_front(1, 1);
+    y.insert_front(2, 2);
+    movable::copies = 0;
+    x.merge(std::move(y));
+    CHECK(movable::copies == 1 && x.size() == 2 && y.size() == 0);
+    CHECK((test::keys_of(x) == std::vector<int>{1, 2}));
+}
+
+// relinking the notes of a source whose lazy index isn't built yet fails before
+// anything is moved, wherever an allocation throws
+void failed_allocations_change_nothing() {
+    using B = binder<int, movable, test::lazy_pmr_traits>;
+    test::counting_resource res;
+    std::pmr::polymorphic_allocator<std::byte> a{&res};
+    for (long budget = 0;; ++budget) {
+        auto x = make<B>(0, 10, a);
+        auto y = make<B>(10, 20, a);
+        res.budget = budget;
+        try {
+            x.splice_after(4, std::move(y));
+        }
+        catch (std::bad_alloc&) {
+            res.budget = -1;
+            CHECK(checked_keys(x) == test::keys_of(make<B>(0, 10)));
+            CHECK(checked_keys(y) == test::keys_of(make<B>(10, 20)));
+            continue;
+        }
+        res.budget = -1;
+        CHECK(x.size() == 20 && y.size() == 0);
+        for (int i = 0; i < 20; ++i)
+            CHECK(std::as_const(x).read(i).v == i);
+        break;
+    }
+}
+
+} // namespace
+
+int main() {
+    moves_notes<default_binder_traits>(true);
+    moves_notes<test::hash_traits>(true);
+    moves_notes<small_traits>(true);
+    moves_notes<test::slab_traits>(true);
+    moves_notes<test::slab_hash_traits>(true);
+    moves_notes<lazy_slab_traits>(true);
+    moves_notes<test::ranked_traits>(false);
+    moves_notes<test::persistent_traits>(false);
+    rejects_splices<default_binder_traits>();
+    rejects_splices<test::slab_hash_traits>();
+    rejects_splices<lazy_slab_traits>();
+    rejects_splices<test::persistent_traits>();
+    failed_copies_change_nothing<default_binder_traits>(true);
+    failed_copies_change_nothing<test::slab_traits>(false);
+    failed_copies_change_nothing<lazy_slab_traits>(false);
+    failed_copies_change_nothing<test::ranked_traits>(false);
+    copies_between_resources();
+    failed_allocations_change_nothing();
+}
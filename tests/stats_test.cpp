@@ -0,0 +1,74 @@
+#include <string>
+#include <vector>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+template <typename B>
+void counts_bytes() {
+    B b;
+    auto st = b.stats();
+    CHECK(st.notes == 0 && st.storage_bytes == 0 && st.index_bytes == 0 && st.use_count == 0);
+    CHECK(st.total_bytes == sizeof(B) && b.memory_footprint() == sizeof(B));
+
+    for (int i = 0; i < 100; ++i)
+        b.insert_front(i, "x");
+    st = b.stats();
+    CHECK(st.notes == 100 && st.storage_bytes > 0 && st.use_count == 1 && st.deep_copies == 0);
+    CHECK(st.total_bytes > sizeof(B) + st.storage_bytes + st.index_bytes);
+    CHECK(st.bytes_per_note == static_cast<double>(st.total_bytes) / 100);
+    CHECK(b.memory_footprint() == st.total_bytes);
+
+    // more notes take more bytes
+    for (int i = 100; i < 1000; ++i)
+        b.insert_front(i, "x");
+    CHECK(b.stats().storage_bytes > st.storage_bytes);
+    CHECK(b.stats().total_bytes > st.total_bytes);
+
+    // an emptied binder holds no data
+    for (int i = 0; i < 1000; ++i)
+        b.remove(i);
+    CHECK(b.stats().bytes_per_note == 0 && b.stats().use_count == 0);
+}
+
+// copies share the data and its deep copy count
+template <typename B>
+void tracks_sharing() {
+    B b;
+    for (int i = 0; i < 100; ++i)
+        b.insert_front(i, "x");
+    B c = b;
+    CHECK(b.stats().use_count == 2 && c.stats().use_count == 2);
+    CHECK(c.stats().total_bytes == b.stats().total_bytes);
+
+    c.remove(5);
+    CHECK(!b.is_shared() && b.stats().use_count == 1);
+    CHECK(c.stats().deep_copies == 1 && c.stats().notes == 99);
+    CHECK(b.stats().deep_copies == 0);
+
+    // a copy forced by a reference from read() is counted as well
+    b.read(3) = "y";
+    B d = b;
+    CHECK(d.stats().deep_copies == 1 && !b.is_shared());
+    B e = c;
+    e.insert_front(-1, "z");
+    CHECK(e.stats().deep_copies == 2);
+}
+
+} // namespace
+
+int main() {
+    counts_bytes<binder<int, std::string>>();
+    counts_bytes<binder<int, std::string, test::slab_hash_traits>>();
+    counts_bytes<binder<int, std::string, test::persistent_traits>>();
+    counts_bytes<small_binder<int, std::string, 4>>();
+    counts_bytes<compact_binder<int, std::string>>();
+    tracks_sharing<binder<int, std::string>>();
+    tracks_sharing<binder<int, std::string, test::slab_hash_traits>>();
+    tracks_sharing<binder<int, std::string, test::persistent_traits>>();
+    tracks_sharing<small_binder<int, std::string, 4>>();
+}
@@ -0,0 +1,156 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// value that counts its copies, which throw once the budget runs out
+struct value {
+    static inline long copies = 0;
+    static inline long budget = -1;
+
+    int v;
+
+    value(int x) : v{x} {}
+
+    value(value const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+        ++copies;
+    }
+
+    value(value&& rhs) noexcept : v{rhs.v} {}
+
+    value& operator=(value const&) = default;
+};
+
+template <typename B>
+B make(int n) {
+    B b;
+    for (int i = 0; i < n; ++i)
+        b.insert_front(i, value{i});
+    return b;
+}
+
+// values are moved out of unshared data, shared data is cloned first
+template <typename Traits>
+void takes_values(bool moves) {
+    using B = binder<int, value, Traits>;
+    auto b = make<B>(10);
+    value::copies = 0;
+    value v = b.take(3);
+    CHECK(v.v == 3 && !b.contains(3) && b.size() == 9);
+    CHECK(!moves || value::copies == 0);
+
+    auto c = b;
+    value w = c.take(4);
+    CHECK(w.v == 4 && b.contains(4) && c.size() == 8 && b.size() == 9);
+    CHECK_THROWS(b.take(100), std::invalid_argument);
+    CHECK_THROWS(B{}.take(1), std::invalid_argument);
+    CHECK(b.size() == 9);
+
+    B one = make<B>(1);
+    CHECK(one.take(0).v == 0 && one.size() == 0 && one.stats().use_count == 0);
+}
+
+// extract_all consumes data it owns alone and copies shared data
+template <typename Traits>
+void extracts_notes(bool moves) {
+    using B = binder<int, value, Traits>;
+    auto b = make<B>(9);
+    value::copies = 0;
+    auto all = std::move(b).extract_all();
+    CHECK(!moves || value::copies == 0);
+    CHECK(all.size() == 9 && b.size() == 0);
+    CHECK(all.front().first == 8 && all.front().second.v == 8 && all.back().first == 0);
+
+    auto c = make<B>(8);
+    auto d = c;
+    value::copies = 0;
+    auto shared = std::move(d).extract_all();
+    CHECK(value::copies == 8 && shared.size() == 8 && c.size() == 8 && d.size() == 0);
+    CHECK(std::move(B{}).extract_all().empty());
+}
+
+// swap exchanges the data without copies
+template <typename Traits>
+void swaps() {
+    using B = binder<int, value, Traits>;
+    auto c = make<B>(8);
+    auto e = make<B>(3);
+    static_assert(noexcept(c.swap(e)));
+    value::copies = 0;
+    swap(c, e);
+    CHECK(c.size() == 3 && e.size() == 8);
+    c.swap(e);
+    CHECK(c.size() == 8 && e.size() == 3 && value::copies == 0);
+    CHECK(std::as_const(c).read(7).v == 7 && !e.contains(7));
+}
+
+// value whose copies throw and whose moves may throw, so it's copied
+struct fragile {
+    static inline long budget = -1;
+
+    int v;
+
+    fragile(int x) : v{x} {}
+
+    fragile(fragile const& rhs) : v{rhs.v} {
+        if (budget == 0)
+            throw std::runtime_error("copy failed");
+        if (budget > 0)
+            --budget;
+    }
+
+    fragile& operator=(fragile const&) = default;
+};
+
+// a failing copy leaves the binder as it was
+template <typename Traits>
+void failures_change_nothing() {
+    using B = binder<int, fragile, Traits>;
+    B t;
+    for (int i = 0; i < 10; ++i)
+        t.insert_front(i, fragile{i});
+
+    fragile::budget = 5;
+    CHECK_THROWS(std::move(t).extract_all(), std::runtime_error);
+    fragile::budget = -1;
+    CHECK(t.size() == 10 && std::as_const(t).read(3).v == 3);
+
+    fragile::budget = 0;
+    CHECK_THROWS(t.take(3), std::runtime_error);
+    fragile::budget = -1;
+    CHECK(t.size() == 10 && std::as_const(t).read(3).v == 3);
+
+    auto r = std::move(t).extract_all();
+    CHECK(r.size() == 10 && t.size() == 0);
+}
+
+} // namespace
+
+int main() {
+    takes_values<default_binder_traits>(true);
+    takes_values<test::slab_hash_traits>(true);
+    takes_values<test::persistent_traits>(false);
+    takes_values<test::lazy_traits>(true);
+    takes_values<test::local_traits>(true);
+    extracts_notes<default_binder_traits>(true);
+    extracts_notes<test::slab_hash_traits>(true);
+    extracts_notes<test::persistent_traits>(false);
+    extracts_notes<test::lazy_traits>(true);
+    extracts_notes<test::local_traits>(true);
+    swaps<default_binder_traits>();
+    swaps<test::persistent_traits>();
+    swaps<compact_binder_traits>();
+    failures_change_nothing<default_binder_traits>();
+    failures_change_nothing<test::slab_hash_traits>();
+}
@@ -0,0 +1,125 @@
+#ifndef BINDER_TEST_SUPPORT_H
+#define BINDER_TEST_SUPPORT_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <memory_resource>
+
+#include "binder.h"
+
+// assert() that stays enabled in release builds
+#define CHECK(cond)                                                                      \
+    do {                                                                                 \
+        if (!(cond)) {                                                                   \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::abort();                                                                \
+        }                                                                                \
+    } while (false)
+
+// checks that expr throws an exception of type E
+#define CHECK_THROWS(expr, E)                                                            \
+    do {                                                                                 \
+        bool thrown = false;                                                             \
+        try {                                                                            \
+            (void)(expr);                                                                \
+        }                                                                                \
+        catch (E const&) {                                                               \
+            thrown = true;                                                               \
+        }                                                                                \
+        CHECK(thrown && "expected " #E);                                                 \
+    } while (false)
+
+namespace test {
+
+// traits that the tests of several features run with
+
+struct hash_traits : cxx::default_binder_traits {
+    using index = cxx::hash_index;
+};
+
+struct slab_traits : cxx::default_binder_traits {
+    using storage = cxx::slab_storage;
+};
+
+struct slab_hash_traits : slab_traits {
+    using index = cxx::hash_index;
+};
+
+struct ranked_traits : cxx::default_binder_traits {
+    using storage = cxx::ranked_storage;
+};
+
+struct persistent_traits : cxx::default_binder_traits {
+    using storage = cxx::persistent_storage;
+};
+
+struct lazy_traits : cxx::default_binder_traits {
+    using index = cxx::lazy_index<>;
+};
+
+struct lazy_pmr_traits : lazy_traits {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+};
+
+struct local_traits : cxx::default_binder_traits {
+    using refcount = cxx::local_refcount;
+};
+
+struct compact_traits : cxx::default_binder_traits {
+    using refcount = cxx::intrusive_refcount;
+};
+
+// memory resource that counts its allocations and the bytes it holds; allocations
+// fail once the budget runs out, a negative budget never does
+class counting_resource : public std::pmr::memory_resource {
+public:
+    std::size_t in_use = 0;
+    std::size_t allocations = 0;
+    long budget = -1;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (budget == 0)
+            throw std::bad_alloc();
+        void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        if (budget > 0)
+            --budget;
+        in_use += bytes;
+        ++allocations;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        in_use -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& rhs) const noexcept override {
+        return this == &rhs;
+    }
+};
+
+// keys of the notes of b in order
+template <typename B>
+auto keys_of(B const& b) {
+    std::vector<typename B::key_type> res;
+    for (auto it = b.cbegin(); it != b.cend(); ++it)
+        res.push_back(it.key());
+    return res;
+}
+
+// values of the notes of b in order
+template <typename B>
+auto values_of(B const& b) {
+    std::vector<typename B::value_type> res;
+    for (auto it = b.cbegin(); it != b.cend(); ++it)
+        res.push_back(*it);
+    return res;
+}
+
+} // namespace test
+
+#endif
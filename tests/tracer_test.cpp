@@ -0,0 +1,102 @@
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// tracer that records every event
+struct recording_tracer {
+    static constexpr bool enabled = true;
+    static inline std::vector<clone_event> events;
+
+    static void on_clone(clone_event const& e) noexcept {
+        events.push_back(e);
+    }
+};
+
+struct traced_traits : default_binder_traits {
+    using tracer = recording_tracer;
+};
+
+struct traced_persistent_traits : traced_traits {
+    using storage = persistent_storage;
+};
+
+struct hook_calls {
+    std::size_t copies = 0;
+    std::size_t writes = 0;
+    std::size_t notes = 0;
+};
+
+hook_calls hooked;
+
+void hook(clone_reason reason, std::size_t notes) noexcept {
+    ++(reason == clone_reason::copy ? hooked.copies : hooked.writes);
+    hooked.notes += notes;
+}
+
+// the tracer is told about each deep copy, with its cause and size
+template <typename Traits>
+void traces_clones() {
+    recording_tracer::events.clear();
+    binder<int, std::string, Traits> b;
+    for (int i = 0; i < 1000; ++i)
+        b.insert_front(i, "x");
+    auto c = b;
+    CHECK(recording_tracer::events.empty());
+    c.remove(3);
+
+    b.read(4) = "y";
+    auto d = b;
+    auto& events = recording_tracer::events;
+    CHECK(events.size() == 2);
+    CHECK(events[0].reason == clone_reason::write && events[0].notes == 1000);
+    CHECK(events[1].reason == clone_reason::copy && events[1].notes == 1000);
+    CHECK(events[0].duration.count() >= 0);
+
+    // mutations of unshared data copy nothing
+    d.insert_front(-1, "z");
+    d.remove(0);
+    CHECK(events.size() == 2);
+}
+
+// the global counters and the hook see every binder, traced or not
+template <typename B>
+void counts_and_hooks() {
+    auto copies = global_clone_counters.on_copy.load();
+    auto writes = global_clone_counters.on_write.load();
+    hooked = {};
+    B b;
+    for (int i = 0; i < 10; ++i)
+        b.insert_front(i, "x");
+    auto c = b;
+    c.remove(0);
+    b.read(1) = "y";
+    auto d = b;
+    CHECK(global_clone_counters.on_copy.load() == copies + 1);
+    CHECK(global_clone_counters.on_write.load() == writes + 1);
+    CHECK(hooked.copies == 1 && hooked.writes == 1 && hooked.notes == 20);
+
+    set_clone_hook(nullptr);
+    auto e = d;
+    e.remove(1);
+    CHECK(hooked.writes == 1);
+    set_clone_hook(hook);
+}
+
+} // namespace
+
+int main() {
+    traces_clones<traced_traits>();
+    traces_clones<traced_persistent_traits>();
+    set_clone_hook(hook);
+    counts_and_hooks<binder<int, std::string>>();
+    counts_and_hooks<binder<int, std::string, traced_traits>>();
+    counts_and_hooks<small_binder<int, std::string, 4>>();
+    counts_and_hooks<compact_binder<int, std::string>>();
+}
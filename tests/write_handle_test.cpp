@@ -0,0 +1,140 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <memory>
+
+#include "binder.h"
+#include "test_support.h"
+
+using namespace cxx;
+
+namespace {
+
+// copies made while a reference from read() may be in use are deep, so writes
+// through the reference reach neither the copy nor later copies of the copy
+template <typename Traits>
+void copies_are_isolated_after_read() {
+    using B = binder<int, std::string, Traits>;
+    B a{{1, "a"}, {2, "b"}};
+    std::string& r = a.read(1);
+    B b = a;
+    B c;
+    c = a;
+    r = "x";
+    CHECK(std::as_const(b).read(1) == "a" && std::as_const(c).read(1) == "a");
+    CHECK(std::as_const(a).read(1) == "x");
+
+    // a modification ends the reference, copies share again
+    a.remove(2);
+    B d = a;
+    CHECK(a.is_shared() && d.is_shared());
+    CHECK(std::as_const(d).read(1) == "x");
+}
+
+// a write handle makes copies deep while it lives only
+template <typename Traits>
+void handles_make_copies_deep_while_alive() {
+    using B = binder<int, std::string, Traits>;
+    B b{{1, "a"}, {2, "b"}};
+    {
+        auto h = b.write(1);
+        *h = "x";
+        B c = b;
+        h->append("y");
+        CHECK(std::as_const(c).read(1) == "x" && std::as_const(b).read(1) == "xy");
+        CHECK(!b.is_shared() && !c.is_shared());
+    }
+    B e = b;
+    CHECK(b.is_shared() && e.is_shared());
+
+    b.modify(2, [](std::string& s) { s = "m"; });
+    CHECK(std::as_const(e).read(2) == "b" && std::as_const(b).read(2) == "m");
+    auto n = b.modify(2, [](std::string& s) { return s.size(); });
+    CHECK(n == 1);
+
+    // a reference returned by fn is copied before the handle goes
+    auto&& m = b.modify(2, [](std::string& s) -> std::string& { return s; });
+    static_assert(std::is_same_v<decltype(m), std::string&&>);
+    CHECK(m == "m");
+    CHECK_THROWS(b.write(9), std::invalid_argument);
+    CHECK_THROWS(B{}.write(1), std::invalid_argument);
+}
+
+// a live handle isn't mistaken for another owner of the data
+template <typename Traits>
+void handles_dont_count_as_sharing() {
+    using B = binder<int, std::string, Traits>;
+    B b{{1, "a"}, {2, "b"}};
+    auto h = b.write(1);
+    auto h2 = b.write(1);
+    CHECK(&*h == &*h2);
+    CHECK(!b.is_shared() && b.stats().use_count == 1);
+    auto clones = global_clone_counters.on_write.load();
+    b.read(2) = "c";
+    CHECK(global_clone_counters.on_write.load() == clones);
+}
+
+// a handle may outlive the data it points into, and the binder itself
+template <typename Traits>
+void handles_outlive_data() {
+    using B = binder<int, std::string, Traits>;
+    {
+        B b{{1, "a"}};
+        auto h = b.write(1);
+        b.remove(1);
+    }
+    {
+        B b{{1, "a"}};
+        auto h = b.write(1);
+        b.clear();
+    }
+    {
+        B b{{1, "a"}};
+        auto h = b.write(1);
+        b = B{{2, "b"}};
+        CHECK(b.contains(2));
+    }
+    {
+        B b{{1, "a"}};
+        b.modify(1, [&b](std::string&) { b.clear(); });
+        CHECK(b.size() == 0);
+    }
+    {
+        auto b = std::make_unique<B>(B{{1, "a"}});
+        auto h = b->write(1);
+        *h = "x";
+        b.reset();
+    }
+    {
+        B b{{1, "a"}};
+        auto h = b.write(1);
+        B moved = std::move(b);
+        *h = "v";
+        CHECK(std::as_const(moved).read(1) == "v");
+        B copy = moved;
+        *h = "w";
+        CHECK(std::as_const(copy).read(1) == "v");
+    }
+}
+
+} // namespace
+
+int main() {
+    copies_are_isolated_after_read<default_binder_traits>();
+    copies_are_isolated_after_read<test::slab_hash_traits>();
+    copies_are_isolated_after_read<test::persistent_traits>();
+    copies_are_isolated_after_read<test::compact_traits>();
+    handles_make_copies_deep_while_alive<default_binder_traits>();
+    handles_make_copies_deep_while_alive<test::slab_hash_traits>();
+    handles_make_copies_deep_while_alive<test::persistent_traits>();
+    handles_make_copies_deep_while_alive<test::local_traits>();
+    handles_dont_count_as_sharing<default_binder_traits>();
+    handles_dont_count_as_sharing<test::persistent_traits>();
+    handles_dont_count_as_sharing<test::compact_traits>();
+    handles_outlive_data<default_binder_traits>();
+    handles_outlive_data<test::slab_hash_traits>();
+    handles_outlive_data<test::persistent_traits>();
+    handles_outlive_data<test::compact_traits>();
+    handles_outlive_data<test::local_traits>();
+}